@@ -0,0 +1,234 @@
+// Benchmarks for long list traversals and reversals.
+// Usage: ./bench.out [elements]
+
+#define _DEFAULT_SOURCE
+
+#include "../forward_list.h"
+#include "../node_pool.h"
+#include "../segment_index.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#define DEFAULT_ELEMENTS 10000000
+
+typedef struct Counter
+{
+    int fd;
+} Counter;
+
+// Hands out nodes one after the other from a single block, so that a list built in one pass is contiguous.
+typedef struct Arena
+{
+    char *memory;
+    size_t used;
+} Arena;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Counts data TLB read misses of the calling thread, if the kernel lets us.
+static Counter counter_open(void)
+{
+    Counter counter = {-1};
+
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  ((unsigned long long)PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    counter.fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+
+    return counter;
+}
+
+static void counter_start(Counter counter)
+{
+#ifdef __linux__
+    if (counter.fd >= 0)
+    {
+        ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+static long long counter_stop(Counter counter)
+{
+    long long value = -1;
+
+#ifdef __linux__
+    if (counter.fd >= 0)
+    {
+        ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter.fd, &value, sizeof(value)) != (ssize_t)sizeof(value))
+            value = -1;
+    }
+#endif
+
+    return value;
+}
+
+static void print_result(const char *name, size_t elements, double seconds, long long misses)
+{
+    printf("%-34s %8.1f ms %7.2f ns/node", name, seconds * 1e3, seconds * 1e9 / (double)elements);
+    if (misses >= 0)
+        printf(" %12lld dTLB misses %6.3f /node\n", misses, (double)misses / (double)elements);
+    else
+        printf("  dTLB misses n/a\n");
+}
+
+// Builds a list whose nodes are linked in a random order, so that consecutive nodes rarely share a page.
+static List *build_scattered_list(size_t elements)
+{
+    Node **nodes = (Node **)malloc(elements * sizeof(Node *));
+    List *list = create_list();
+    if (!nodes)
+    {
+        fprintf(stderr, "Allocation failed");
+        exit(EXIT_FAILURE);
+    }
+
+    assign(list, elements, 1);
+
+    size_t i = 0;
+    for (Node *p = list->head; p != NULL; p = p->pNext)
+        nodes[i++] = p;
+
+    for (i = elements - 1; i > 0; --i)
+    {
+        size_t j = ((size_t)rand() * ((size_t)RAND_MAX + 1) + (size_t)rand()) % (i + 1);
+        Node *temp = nodes[i];
+        nodes[i] = nodes[j];
+        nodes[j] = temp;
+    }
+
+    for (i = 0; i + 1 < elements; ++i)
+        nodes[i]->pNext = nodes[i + 1];
+    nodes[elements - 1]->pNext = NULL;
+    list->head = nodes[0];
+    list->tail = nodes[elements - 1];
+
+    free(nodes);
+    return list;
+}
+
+static void *arena_alloc(size_t size, void *ctx)
+{
+    Arena *arena = (Arena *)ctx;
+    void *p = arena->memory + arena->used;
+    arena->used += size;
+
+    return p;
+}
+
+static void arena_free(void *ptr, void *ctx)
+{
+}
+
+// Returns the list, so that its nodes are not reused by the next run.
+static List *bench_traversal(const char *name, size_t elements, Counter counter)
+{
+    List *list = build_scattered_list(elements);
+
+    counter_start(counter);
+    double start = now();
+    const_iterator found = cfind(cbegin(list), cend(list), 0);
+    double seconds = now() - start;
+    long long misses = counter_stop(counter);
+
+    if (found.current)
+        printf("unexpected match\n");
+
+    print_result(name, elements, seconds, misses);
+
+    return list;
+}
+
+// Times reverse() of a scattered list, or of a contiguous one if not "scattered". With "threads" set,
+// a segment index is attached first, outside of the timing.
+static void bench_reverse(const char *name, size_t elements, Counter counter, int scattered, unsigned threads)
+{
+    Arena arena = {NULL, 0};
+    List *list;
+    if (scattered)
+        list = build_scattered_list(elements);
+    else
+    {
+        arena.memory = (char *)malloc(sizeof(List) + elements * sizeof(Node));
+        if (!arena.memory)
+        {
+            fprintf(stderr, "Allocation failed");
+            exit(EXIT_FAILURE);
+        }
+        list = create_list_with_allocator(arena_alloc, arena_free, &arena);
+        assign(list, elements, 1);
+    }
+    if (threads)
+        segment_index_attach(list, elements / (4 * threads) + 1, threads);
+
+    counter_start(counter);
+    double start = now();
+    reverse(list);
+    double seconds = now() - start;
+    long long misses = counter_stop(counter);
+
+    print_result(name, elements, seconds, misses);
+
+    destroy_list(list);
+    free(arena.memory);
+}
+
+int main(int argc, char **argv)
+{
+    size_t elements = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : DEFAULT_ELEMENTS;
+    Counter counter = counter_open();
+
+    srand(42);
+    printf("Scattered traversal of %zu elements\n", elements);
+
+    List *regular = bench_traversal("cfind, regular pages", elements, counter);
+
+    node_pool_use_huge_pages(1);
+    List *huge = bench_traversal("cfind, huge page chunks", elements, counter);
+    node_pool_use_huge_pages(0);
+
+    destroy_list(regular);
+    destroy_list(huge);
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned threads = online > 0 ? (unsigned)online : 1;
+
+    printf("\nReversal of %zu elements, %u threads\n", elements, threads);
+    bench_reverse("reverse, scattered", elements, counter, 1, 0);
+    bench_reverse("reverse, scattered, segments", elements, counter, 1, threads);
+    bench_reverse("reverse, contiguous", elements, counter, 0, 0);
+    bench_reverse("reverse, contiguous, segments", elements, counter, 0, threads);
+
+    NodePoolChunkStats stats = node_pool_chunk_stats();
+    printf("chunks: %zu, hugetlb: %zu, transparent huge pages: %zu\n", stats.chunks, stats.hugetlb_chunks,
+           stats.transparent_huge_chunks);
+
+    return 0;
+}
@@ -1,8 +1,35 @@
 #include "forward_list.h"
+#include "hash_index.h"
+#include "node_pool.h"
+#include "reclaimer.h"
+#include "segment_index.h"
+#include "skip_index.h"
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 
+#define TEXT_BUFFER_SIZE 65536
+#define SORT_MIN_RUN 16
+#define SORT_MAX_RUNS 96
+
+// Scratch hash set of unique_all(). A slot is in use if its stamp is the current one, so emptying the
+// set between calls only takes a new stamp.
+typedef struct SeenSet
+{
+    int *values;
+    unsigned *stamps;
+    unsigned bits;
+    unsigned stamp;
+} SeenSet;
+
+static pthread_once_t seen_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t seen_key;
+static _Thread_local SeenSet seen;
+
 List *create_list(void)
 {
     List *this = (List *)malloc(sizeof(struct List));
@@ -11,24 +38,76 @@ List *create_list(void)
         fprintf(stderr, "Allocation failed");
         exit(EXIT_FAILURE);
     }
+    this->before_head.value = 0;
+    this->head = NULL;
+    this->tail = &this->before_head;
+    this->alloc_fn = NULL;
+    this->free_fn = NULL;
+    this->alloc_ctx = NULL;
+    this->list_free_fn = NULL;
+    this->list_ctx = NULL;
+    this->version = 0;
+    this->sorted = 1;
+    this->skip_index = NULL;
+    this->hash_index = NULL;
+    this->segment_index = NULL;
+
+    return this;
+}
+
+List *create_list_with_allocator(void *(*alloc_fn)(size_t size, void *ctx), void (*free_fn)(void *ptr, void *ctx),
+                                 void *ctx)
+{
+    List *this = (List *)alloc_fn(sizeof(struct List), ctx);
+    if (!this)
+    {
+        fprintf(stderr, "Allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    this->before_head.value = 0;
     this->head = NULL;
+    this->tail = &this->before_head;
+    this->alloc_fn = alloc_fn;
+    this->free_fn = free_fn;
+    this->alloc_ctx = ctx;
+    this->list_free_fn = free_fn;
+    this->list_ctx = ctx;
+    this->version = 0;
+    this->sorted = 1;
+    this->skip_index = NULL;
+    this->hash_index = NULL;
+    this->segment_index = NULL;
 
     return this;
 }
 
 void destroy_list(List *this)
 {
-    while (!empty(this))
-        pop_front(this);
+    skip_index_detach(this);
+    hash_index_detach(this);
+    segment_index_detach(this);
+    clear(this);
 
-    free(this);
+    if (this->list_free_fn)
+        this->list_free_fn(this, this->list_ctx);
+    else
+        free(this);
 }
 
 // Static Functions
 
-static Node *createNode(void)
+// Records a change to the list.
+static void modified(List *this)
+{
+    ++this->version;
+}
+
+static Node *createNode(List *this)
 {
-    Node *pNewNode = (Node *)malloc(sizeof(Node));
+    if (!this->alloc_fn)
+        return node_pool_alloc();
+
+    Node *pNewNode = (Node *)this->alloc_fn(sizeof(Node), this->alloc_ctx);
     if (!pNewNode)
     {
         fprintf(stderr, "Allocation failed");
@@ -38,22 +117,234 @@ static Node *createNode(void)
     return pNewNode;
 }
 
-static int icmp(const void *vp1, const void *vp2)
+static void destroyNode(List *this, Node *pNode)
+{
+    if (!this->free_fn)
+        node_pool_free(pNode);
+    else
+        this->free_fn(pNode, this->alloc_ctx);
+}
+
+// Releases the nodes from "first" up to, but not including, "end" as one batch.
+static void destroyRange(List *this, Node *first, const Node *end)
+{
+    void (*free_fn)(void *ptr, void *ctx) = this->free_fn;
+    void *ctx = this->alloc_ctx;
+
+    // Custom allocators are released right away: they need not be thread-safe, and their context may be
+    // gone once the list is.
+    if (!free_fn && reclaimer_running())
+        reclaimer_submit(first, end, NULL, NULL);
+    else if (!free_fn)
+        node_pool_free_range(first, end);
+    else
+    {
+        while (first != end)
+        {
+            Node *next = first->pNext;
+            free_fn(first, ctx);
+            first = next;
+        }
+    }
+}
+
+// Returns "count" linked nodes with uninitialized values and stores the last one in "tail".
+static Node *createChain(List *this, size_t count, Node **tail)
+{
+    if (!this->alloc_fn)
+        return node_pool_alloc_chain(count, tail);
+
+    Node *first = createNode(this);
+    Node *last = first;
+    while (--count)
+    {
+        last->pNext = createNode(this);
+        last = last->pNext;
+    }
+    last->pNext = NULL;
+
+    *tail = last;
+    return first;
+}
+
+static int same_allocator(const List *this, const List *other)
+{
+    return this->alloc_fn == other->alloc_fn && this->free_fn == other->free_fn && this->alloc_ctx == other->alloc_ctx;
+}
+
+// Prepares the chain from "first" to "*last", which is being moved from "from" to "to".
+// If the lists use different allocators the nodes are copied with the allocator of "to" and the originals
+// are released. Returns the first node of the chain to link and updates "*last".
+static Node *adoptChain(List *to, List *from, Node *first, Node **last)
+{
+    if (same_allocator(to, from))
+        return first;
+
+    const Node *end = (*last)->pNext;
+    Node *copy = createNode(to);
+    Node *copy_last = copy;
+    copy->value = first->value;
+
+    for (Node *p = first->pNext; p != end; p = p->pNext)
+    {
+        copy_last->pNext = createNode(to);
+        copy_last = copy_last->pNext;
+        copy_last->value = p->value;
+    }
+    copy_last->pNext = NULL;
+
+    destroyRange(from, first, end);
+
+    *last = copy_last;
+    return copy;
+}
+
+// Key of sort_by_key(); "value" is the element the key was computed from.
+typedef struct SortKey
+{
+    long long key;
+    int value;
+} SortKey;
+
+// How sort() and merge() order elements: by "cmp" if set, by the keys indexed by the values if "keys" is
+// set, and in ascending order otherwise.
+typedef struct SortOrder
+{
+    int (*cmp)(int a, int b);
+    const SortKey *keys;
+} SortOrder;
+
+static const SortOrder ascending = {NULL, NULL};
+
+// Compares without subtracting, which would overflow for values far apart.
+static int icmp(int a, int b)
+{
+    return (a > b) - (a < b);
+}
+
+static int compare(const SortOrder *order, int a, int b)
 {
-    return *(const int *)vp1 - *(const int *)vp2;
+    if (order->cmp)
+        return order->cmp(a, b);
+    if (order->keys)
+        return (order->keys[a].key > order->keys[b].key) - (order->keys[a].key < order->keys[b].key);
+    return icmp(a, b);
+}
+
+// Merges the sorted, NULL-terminated chains "a" and "b", whose last nodes are "a_last" and "b_last".
+// Equal elements of "a" come first. Links are only rewritten where the merged order switches chains.
+// Returns the first node of the result and stores its last node in "last".
+static Node *mergeChains(Node *a, Node *a_last, Node *b, Node *b_last, Node **last, const SortOrder *order)
+{
+    if (compare(order, a_last->value, b->value) <= 0)
+    {
+        a_last->pNext = b;
+        *last = b_last;
+        return a;
+    }
+    if (compare(order, b_last->value, a->value) < 0)
+    {
+        b_last->pNext = a;
+        *last = a_last;
+        return b;
+    }
+
+    Node head;
+    Node *prev = &head;
+    head.pNext = a;
+    while (a && b)
+    {
+        if (compare(order, b->value, a->value) < 0)
+        {
+            Node *run_last = b;
+            while (run_last->pNext && compare(order, run_last->pNext->value, a->value) < 0)
+                run_last = run_last->pNext;
+
+            prev->pNext = b;
+            b = run_last->pNext;
+            run_last->pNext = a;
+            prev = run_last;
+        }
+        else
+        {
+            while (a->pNext && compare(order, a->pNext->value, b->value) <= 0)
+                a = a->pNext;
+
+            prev = a;
+            a = a->pNext;
+        }
+    }
+
+    if (b)
+    {
+        prev->pNext = b;
+        *last = b_last;
+    }
+    else
+        *last = a_last;
+
+    return head.pNext;
 }
 
 void assign(List *this, size_t count, int value)
 {
     clear(this);
-    while (count--)
-        push_front(this, value);
+    if (!count)
+        return;
+
+    this->head = createChain(this, count, &this->tail);
+    for (Node *p = this->head; p != NULL; p = p->pNext)
+        p->value = value;
+}
+
+void assign_array(List *this, const int *arr, size_t size)
+{
+    clear(this);
+    if (!size)
+        return;
+
+    this->head = createChain(this, size, &this->tail);
+
+    size_t i = 0;
+    for (Node *p = this->head; p != NULL; p = p->pNext)
+    {
+        if (i && arr[i - 1] > arr[i])
+            this->sorted = 0;
+        p->value = arr[i++];
+    }
+}
+
+iterator before_begin(List *this)
+{
+    iterator iter;
+    iter.current = &this->before_head;
+    iter.owner = this;
+
+    return iter;
+}
+
+const_iterator cbefore_begin(List *this)
+{
+    const_iterator iter;
+    iter.current = &this->before_head;
+
+    return iter;
+}
+
+iterator before_end(List *this)
+{
+    iterator iter;
+    iter.current = this->tail;
+    iter.owner = this;
+
+    return iter;
 }
 
 iterator begin(List *this)
 {
     iterator iter;
     iter.current = this->head;
+    iter.owner = this;
 
     return iter;
 }
@@ -76,8 +367,11 @@ const_iterator cend(List *this)
 
 void clear(List *this)
 {
-    while (!empty(this))
-        pop_front(this);
+    destroyRange(this, this->head, NULL);
+    this->head = NULL;
+    this->tail = &this->before_head;
+    this->sorted = 1;
+    modified(this);
 }
 
 int empty(List *this)
@@ -89,204 +383,421 @@ iterator end(List *this)
 {
     iterator iter;
     iter.current = NULL;
+    iter.owner = this;
 
     return iter;
 }
 
 iterator erase_after(iterator pos)
 {
+    assert(pos.owner);
+
     Node *temp = pos.current->pNext;
+    if (pos.owner->tail == temp)
+        pos.owner->tail = pos.current;
+
     pos.current->pNext = pos.current->pNext->pNext;
+    modified(pos.owner);
+    if (pos.owner->hash_index)
+        hash_index_erased(pos.owner->hash_index, pos.current, temp);
     pos.current = pos.current->pNext;
-    free(temp);
+    destroyNode(pos.owner, temp);
 
     return pos;
 }
 
+iterator erase_after_range(iterator first, iterator last)
+{
+    assert(first.owner);
+
+    Node *erased = first.current->pNext;
+    if (erased != last.current)
+    {
+        if (!last.current)
+            first.owner->tail = first.current;
+        first.current->pNext = last.current;
+        if (!first.owner->head)
+            first.owner->sorted = 1;
+        destroyRange(first.owner, erased, last.current);
+        modified(first.owner);
+    }
+
+    return last;
+}
+
 int *front(List *this)
+{
+    // The element may be written through the pointer.
+    invalidate(this);
+    return &(this->head->value);
+}
+
+const int *cfront(const List *this)
 {
     return &(this->head->value);
 }
 
+void invalidate(List *this)
+{
+    this->sorted = 0;
+    modified(this);
+}
+
 iterator insert_after(iterator pos, int value)
 {
-    Node *pNewNode = createNode();
+    assert(pos.owner);
+
+    Node *pNewNode = createNode(pos.owner);
+
+    // The list stays sorted if the value fits between its neighbours.
+    if (pos.owner->sorted)
+    {
+        const Node *after = pos.current->pNext;
+        pos.owner->sorted = (pos.current == &pos.owner->before_head || pos.current->value <= value) &&
+                            (!after || value <= after->value);
+    }
 
     pNewNode->value = value;
     pNewNode->pNext = pos.current->pNext;
     pos.current->pNext = pNewNode;
+    if (pos.owner->tail == pos.current)
+        pos.owner->tail = pNewNode;
+    modified(pos.owner);
+    if (pos.owner->hash_index)
+        hash_index_inserted(pos.owner->hash_index, pos.current, pNewNode);
     pos.current = pNewNode;
 
     return pos;
 }
 
+iterator insert_sorted(List *this, int value)
+{
+    sort(this);
+
+    iterator pos = before_end(this);
+    if (pos.current != &this->before_head && value < pos.current->value)
+    {
+        pos.current = &this->before_head;
+        while (pos.current->pNext && pos.current->pNext->value <= value)
+            pos.current = pos.current->pNext;
+    }
+
+    return insert_after(pos, value);
+}
+
 void merge(List *this, List *other)
 {
-    if (this->head == other->head)
+    if (this == other)
+        return;
+
+    if (other->head && !same_allocator(this, other))
+    {
+        Node *last = before_end(other).current;
+        other->head = adoptChain(this, other, other->head, &last);
+        other->tail = last;
+    }
+
+    Node *a = this->head;
+    Node *b = other->head;
+    if (!b)
         return;
 
-    if (!this->head) // If list1 is empty, simply point its head to list2's head
-        this->head = other->head;
+    Node *b_last = before_end(other).current;
 
-    else if (other->head) // If list2 is not empty
+    if (a)
+        this->head = mergeChains(a, before_end(this).current, b, b_last, &this->tail, &ascending);
+    else
     {
-        Node *curr1 = this->head;
-        Node *curr2 = other->head;
-        Node *prev1 = NULL;
+        this->head = b;
+        this->tail = b_last;
+    }
 
-        while (curr1 && curr2)
-        {
-            if (curr2->value < curr1->value)
-            {
-                if (!prev1)
-                    this->head = curr2;
-                else
-                    prev1->pNext = curr2;
+    other->head = NULL;
+    other->tail = &other->before_head;
+    this->sorted = this->sorted && other->sorted;
+    other->sorted = 1;
+    modified(this);
+    modified(other);
+}
 
-                prev1 = curr2;
-                curr2 = curr2->pNext;
-                prev1->pNext = curr1;
-            }
-            else
-            {
-                prev1 = curr1;
-                curr1 = curr1->pNext;
-            }
+// A list head in the heap of merge_many(). "source" orders equal values, which keeps the merge stable.
+typedef struct MergeHead
+{
+    Node *node;
+    size_t source;
+} MergeHead;
+
+static int head_less(const MergeHead *a, const MergeHead *b)
+{
+    return a->node->value < b->node->value || (a->node->value == b->node->value && a->source < b->source);
+}
+
+static void sift_down(MergeHead *heap, size_t size, size_t i)
+{
+    MergeHead moving = heap[i];
+    for (;;)
+    {
+        size_t child = 2 * i + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && head_less(&heap[child + 1], &heap[child]))
+            ++child;
+        if (!head_less(&heap[child], &moving))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = moving;
+}
+
+// Merges the "k" sources into "dst". "heap" and "tails" have room for k + 1 entries.
+static void merge_sources(List *dst, List **srcs, size_t k, MergeHead *heap, Node **tails)
+{
+    size_t size = 0;
+    int sorted = dst->sorted;
+
+    for (size_t i = 0; i <= k; ++i)
+    {
+        List *list = i ? srcs[i - 1] : dst;
+        if ((i && list == dst) || !list->head)
+            continue;
+
+        tails[i] = before_end(list).current;
+        if (!same_allocator(dst, list))
+            list->head = adoptChain(dst, list, list->head, &tails[i]);
+
+        heap[size].node = list->head;
+        heap[size].source = i;
+        ++size;
+        sorted = sorted && list->sorted;
+
+        if (i)
+        {
+            list->head = NULL;
+            list->tail = &list->before_head;
+            list->sorted = 1;
+            modified(list);
         }
+    }
+
+    if (!size)
+        return;
 
-        if (!curr1 && prev1)
-            prev1->pNext = curr2;
+    for (size_t i = size / 2; i-- > 0;)
+        sift_down(heap, size, i);
 
-        else if (!this->head)
-            this->head = other->head;
+    // Take the smallest head until a single list is left, whose rest is linked as it is.
+    Node *prev = &dst->before_head;
+    while (size > 1)
+    {
+        prev->pNext = heap[0].node;
+        prev = heap[0].node;
+        heap[0].node = prev->pNext;
+        if (!heap[0].node)
+            heap[0] = heap[--size];
+        sift_down(heap, size, 0);
     }
 
-    other->head = NULL;
+    prev->pNext = heap[0].node;
+    dst->tail = tails[heap[0].source];
+    dst->sorted = sorted;
+    modified(dst);
 }
 
-void pop_front(List *this)
+void merge_many(List *dst, List **srcs, size_t k)
 {
-    Node *pDel = this->head;
-    this->head = this->head->pNext;
+    if (k < MERGE_MANY_WAYS)
+    {
+        MergeHead heap[MERGE_MANY_WAYS];
+        Node *tails[MERGE_MANY_WAYS];
+        merge_sources(dst, srcs, k, heap, tails);
+        return;
+    }
 
-    free(pDel);
+    // MergeHead is at least as aligned as a pointer, so the tails can follow the heap.
+    MergeHead *heap = (MergeHead *)malloc((k + 1) * (sizeof(MergeHead) + sizeof(Node *)));
+    if (!heap)
+    {
+        fprintf(stderr, "Allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    merge_sources(dst, srcs, k, heap, (Node **)(heap + k + 1));
+    free(heap);
 }
 
-void push_front(List *this, int value)
+void pop_front(List *this)
 {
-    Node *pNewNode = createNode();
+    erase_after(before_begin(this));
+}
 
-    pNewNode->value = value;
-    pNewNode->pNext = this->head;
-    this->head = pNewNode;
+void push_front(List *this, int value)
+{
+    insert_after(before_begin(this), value);
 }
 
 int remove_(List *this, int value)
 {
+    if (this->hash_index)
+        return (int)hash_index_remove(this->hash_index, value);
+
     int count = 0;
-    int first = 1;
-    Node *p = this->head;
-    Node *prev = this->head;
-    while (p)
+    Node *prev = &this->before_head;
+    while (prev->pNext)
     {
+        Node *p = prev->pNext;
         if (p->value != value)
         {
-            if (first)
-                first = 0;
             prev = p;
-            p = p->pNext;
             continue;
         }
 
-        Node *temp = p;
         prev->pNext = p->pNext;
-        if (first)
-            this->head = prev->pNext;
-
-        p = p->pNext;
         ++count;
-        free(temp);
+        destroyNode(this, p);
+    }
+
+    this->tail = prev;
+    if (count)
+        modified(this);
+    return count;
+}
+
+int remove_if_batch(List *this, void (*pred)(const int *values, size_t n, uint8_t *mask))
+{
+    Node *nodes[REMOVE_BATCH_SIZE];
+    int values[REMOVE_BATCH_SIZE];
+    uint8_t mask[REMOVE_BATCH_SIZE];
+    Node removed;
+    Node *removed_last = &removed;
+    Node *prev = &this->before_head;
+    int count = 0;
+
+    while (prev->pNext)
+    {
+        size_t n = 0;
+        for (Node *p = prev->pNext; p != NULL && n < REMOVE_BATCH_SIZE; p = p->pNext, ++n)
+        {
+            nodes[n] = p;
+            values[n] = p->value;
+        }
+        Node *after = nodes[n - 1]->pNext;
+
+        pred(values, n, mask);
+
+        // Links are only rewritten where a run of kept nodes meets a run of removed ones.
+        size_t i = 0;
+        while (i < n)
+        {
+            size_t j = i;
+            if (!mask[i])
+            {
+                while (j < n && !mask[j])
+                    ++j;
+                if (prev->pNext != nodes[i])
+                    prev->pNext = nodes[i];
+                prev = nodes[j - 1];
+            }
+            else
+            {
+                while (j < n && mask[j])
+                    ++j;
+                removed_last->pNext = nodes[i];
+                removed_last = nodes[j - 1];
+                count += (int)(j - i);
+            }
+            i = j;
+        }
+
+        if (prev->pNext != after)
+            prev->pNext = after;
+    }
+
+    this->tail = prev;
+    if (count)
+    {
+        removed_last->pNext = NULL;
+        destroyRange(this, removed.pNext, NULL);
+        modified(this);
     }
 
     return count;
 }
 
+size_t count(List *this, int value)
+{
+    if (this->hash_index)
+        return hash_index_count(this->hash_index, value);
+
+    size_t matches = 0;
+    for (const Node *p = this->head; p != NULL; p = p->pNext)
+        matches += p->value == value;
+
+    return matches;
+}
+
+int contains(List *this, int value)
+{
+    if (this->hash_index)
+        return hash_index_find(this->hash_index, value).current != NULL;
+
+    return cfind(cbegin(this), cend(this), value).current != NULL;
+}
+
 int remove_if(List *this, int (*unPred)(const int *value))
 {
     int count = 0;
-    int first = 1;
-    Node *p = this->head;
-    Node *prev = this->head;
-    while (p)
+    Node *prev = &this->before_head;
+    while (prev->pNext)
     {
+        Node *p = prev->pNext;
         if (!unPred(&p->value))
         {
-            if (first)
-                first = 0;
             prev = p;
-            p = p->pNext;
             continue;
         }
 
-        Node *temp = p;
         prev->pNext = p->pNext;
-        if (first)
-            this->head = prev->pNext;
-
-        p = p->pNext;
         ++count;
-        free(temp);
+        destroyNode(this, p);
     }
 
+    this->tail = prev;
+    if (count)
+        modified(this);
     return count;
 }
 
 void resize(List *this, size_t count)
 {
-    size_t size = distance(cbegin(this), cend(this));
-
-    if (count == size)
-        return;
-
-    else if (count < size)
-    {
-        reverse(this);
-        for (size_t i = 0; i < count; i++)
-            pop_front(this);
-        reverse(this);
-    }
-
-    else
-    {
-        reverse(this);
-        for (size_t i = 0; i < count - size; i++)
-            push_front(this, 0);
-        reverse(this);
-    }
+    resize_value(this, count, 0);
 }
 
 void resize_value(List *this, size_t count, int value)
 {
-    size_t size = distance(cbegin(this), cend(this));
-
-    if (count == size)
-        return;
-
-    else if (count < size)
+    // A single walk to the new end decides whether to cut or to grow.
+    iterator pos = before_begin(this);
+    size_t size = 0;
+    while (size < count && pos.current->pNext)
     {
-        reverse(this);
-        for (size_t i = 0; i < count; i++)
-            pop_front(this);
-        reverse(this);
+        pos.current = pos.current->pNext;
+        ++size;
     }
 
-    else
+    if (size == count)
     {
-        reverse(this);
-        for (size_t i = 0; i < count - size; i++)
-            push_front(this, value);
-        reverse(this);
+        erase_after_range(pos, end(this));
+        return;
     }
+
+    Node *last;
+    Node *chain = createChain(this, count - size, &last);
+    for (Node *p = chain; p != NULL; p = p->pNext)
+        p->value = value;
+
+    this->sorted = pos.current == &this->before_head || (this->sorted && pos.current->value <= value);
+    pos.current->pNext = chain;
+    this->tail = last;
+    modified(this);
 }
 
 void reverse(List *this)
@@ -295,29 +806,155 @@ void reverse(List *this)
     Node *prev = NULL;
     Node *next = NULL;
 
-    while (current)
-    {
-        next = current->pNext;
-        current->pNext = prev;
-        prev = current;
-        current = next;
+    this->tail = current ? current : &this->before_head;
+
+    if (this->segment_index)
+        prev = segment_index_reverse(this->segment_index);
+    else
+    {
+        while (current)
+        {
+            next = current->pNext;
+            current->pNext = prev;
+            prev = current;
+            current = next;
+        }
     }
 
     this->head = prev;
+    this->sorted = !prev || !prev->pNext;
+    modified(this);
+
+    // The index was reversed along with the list.
+    if (this->segment_index)
+        this->segment_index->version = this->version;
+}
+
+// A sorted run of sort(), NULL-terminated.
+typedef struct SortRun
+{
+    Node *first;
+    Node *last;
+    size_t length;
+} SortRun;
+
+// Detaches the run starting at "p" and stores the node after it in "rest". A strictly descending run is
+// reversed; keeping equal elements out of it keeps the sort stable. Short runs are extended to
+// SORT_MIN_RUN nodes by insertion, which is cheaper than merging tiny runs.
+static SortRun takeRun(Node *p, Node **rest, const SortOrder *order)
+{
+    SortRun run = {p, p, 1};
+    Node *next = p->pNext;
+
+    if (next && compare(order, next->value, p->value) < 0)
+    {
+        p->pNext = NULL;
+        while (next && compare(order, next->value, run.first->value) < 0)
+        {
+            Node *after = next->pNext;
+            next->pNext = run.first;
+            run.first = next;
+            next = after;
+            ++run.length;
+        }
+    }
+    else
+    {
+        while (next && compare(order, next->value, run.last->value) >= 0)
+        {
+            run.last = next;
+            next = next->pNext;
+            ++run.length;
+        }
+        run.last->pNext = NULL;
+    }
+
+    while (next && run.length < SORT_MIN_RUN)
+    {
+        Node *node = next;
+        next = next->pNext;
+        ++run.length;
+
+        if (compare(order, node->value, run.last->value) >= 0)
+        {
+            run.last->pNext = node;
+            run.last = node;
+            node->pNext = NULL;
+            continue;
+        }
+
+        Node head;
+        Node *prev = &head;
+        head.pNext = run.first;
+        while (compare(order, prev->pNext->value, node->value) <= 0)
+            prev = prev->pNext;
+        node->pNext = prev->pNext;
+        prev->pNext = node;
+        run.first = head.pNext;
+    }
+
+    *rest = next;
+    return run;
+}
+
+// Merges runs[i] with runs[i + 1] and closes the gap on the stack.
+static void mergeAt(SortRun *runs, size_t *count, size_t i, const SortOrder *order)
+{
+    SortRun *left = &runs[i];
+    SortRun *right = &runs[i + 1];
+
+    left->first = mergeChains(left->first, left->last, right->first, right->last, &left->last, order);
+    left->length += right->length;
+
+    if (i + 2 < *count)
+        runs[i + 1] = runs[i + 2];
+    --*count;
+}
+
+// Sorts the nodes of the list by relinking them, stably.
+static void sortNodes(List *this, const SortOrder *order)
+{
+    // Runs are merged as soon as the stack would stop growing like the Fibonacci numbers, the
+    // invariant of TimSort, which bounds the stack depth by the logarithm of the list length.
+    SortRun runs[SORT_MAX_RUNS];
+    size_t count = 0;
+    Node *rest = this->head;
+
+    while (rest)
+    {
+        runs[count++] = takeRun(rest, &rest, order);
+
+        while (count > 1)
+        {
+            size_t n = count - 2;
+            if ((n > 0 && runs[n - 1].length <= runs[n].length + runs[n + 1].length) ||
+                (n > 1 && runs[n - 2].length <= runs[n - 1].length + runs[n].length))
+            {
+                if (runs[n - 1].length < runs[n + 1].length)
+                    --n;
+            }
+            else if (runs[n].length > runs[n + 1].length)
+                break;
+
+            mergeAt(runs, &count, n, order);
+        }
+    }
+
+    while (count > 1)
+        mergeAt(runs, &count, count - 2, order);
+
+    this->head = runs[0].first;
+    this->tail = runs[0].last;
+    modified(this);
 }
 
 void sort(List *this)
 {
-    if (!this->head)
+    if (this->sorted || !this->head)
         return;
-    
-    int *arr = to_array(this);
-    size_t size = distance(cbegin(this), cend(this));
-    qsort(arr, size, sizeof(*arr), &icmp);
-    List *sorted = to_forward_list(arr, size);
-    swap(this, sorted);
-    free(arr);
-    destroy_list(sorted);
+
+    sortNodes(this, &ascending);
+    this->sorted = 1;
 
     // the first iteration had this very slow bubble sort
     // if (!empty(this))
@@ -340,6 +977,272 @@ void sort(List *this)
     // }
 }
 
+void sort_by(List *this, int (*cmp)(int a, int b))
+{
+    if (!this->head)
+        return;
+
+    SortOrder order = {cmp, NULL};
+    sortNodes(this, &order);
+    this->sorted = 0;
+}
+
+void sort_by_key(List *this, long long (*key_fn)(int value))
+{
+    if (!this->head)
+        return;
+
+    size_t size = distance(cbegin(this), cend(this));
+    SortKey *keys = (SortKey *)malloc(size * sizeof(SortKey));
+    if (!keys)
+    {
+        fprintf(stderr, "Allocation failed");
+        exit(EXIT_FAILURE);
+    }
+
+    // Each node holds the index of its key while the nodes are sorted, then gets its value back.
+    int i = 0;
+    for (Node *p = this->head; p != NULL; p = p->pNext, ++i)
+    {
+        keys[i].key = key_fn(p->value);
+        keys[i].value = p->value;
+        p->value = i;
+    }
+
+    SortOrder order = {NULL, keys};
+    sortNodes(this, &order);
+
+    for (Node *p = this->head; p != NULL; p = p->pNext)
+        p->value = keys[p->value].value;
+    free(keys);
+
+    this->sorted = 0;
+}
+
+// Max-heap of nodes by value for partial_sort().
+static void sift_up_max(Node **heap, size_t i)
+{
+    Node *moving = heap[i];
+    while (i && heap[(i - 1) / 2]->value < moving->value)
+    {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = moving;
+}
+
+static void sift_down_max(Node **heap, size_t size, size_t i)
+{
+    Node *moving = heap[i];
+    for (;;)
+    {
+        size_t child = 2 * i + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && heap[child]->value < heap[child + 1]->value)
+            ++child;
+        if (heap[child]->value <= moving->value)
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = moving;
+}
+
+void partial_sort(List *this, size_t k)
+{
+    if (!k || this->sorted)
+        return;
+
+    size_t size = distance(cbegin(this), cend(this));
+    if (k >= size)
+    {
+        sort(this);
+        return;
+    }
+
+    Node **heap = (Node **)malloc(k * sizeof(Node *));
+    if (!heap)
+    {
+        fprintf(stderr, "Allocation failed");
+        exit(EXIT_FAILURE);
+    }
+
+    // The k smallest nodes seen so far stay in the heap, everything else is moved to "rest" in the order it
+    // leaves, so each node is unlinked once and relinked once.
+    Node rest;
+    Node *rest_last = &rest;
+    size_t used = 0;
+    Node *p = this->head;
+    while (p)
+    {
+        Node *next = p->pNext;
+        Node *out = p;
+
+        if (used < k)
+        {
+            heap[used] = p;
+            sift_up_max(heap, used++);
+            out = NULL;
+        }
+        else if (p->value < heap[0]->value)
+        {
+            out = heap[0];
+            heap[0] = p;
+            sift_down_max(heap, k, 0);
+        }
+
+        if (out)
+        {
+            rest_last->pNext = out;
+            rest_last = out;
+        }
+        p = next;
+    }
+    rest_last->pNext = NULL;
+
+    // Popping the maximum and linking it in front builds the sorted prefix from its end.
+    Node *first = rest.pNext;
+    while (used)
+    {
+        Node *largest = heap[0];
+        heap[0] = heap[--used];
+        sift_down_max(heap, used, 0);
+
+        largest->pNext = first;
+        first = largest;
+    }
+    free(heap);
+
+    this->head = first;
+    this->tail = rest_last;
+    modified(this);
+}
+
+// A NULL-terminated chain of nodes; "last" is only meaningful if "first" is not NULL.
+typedef struct Chain
+{
+    Node *first;
+    Node *last;
+} Chain;
+
+static void prepend_chain(Chain *chain, Chain front)
+{
+    if (!front.first)
+        return;
+
+    front.last->pNext = chain->first;
+    if (!chain->first)
+        chain->last = front.last;
+    chain->first = front.first;
+}
+
+// xorshift64, so that picking pivots leaves the sequence of rand() to the caller.
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+
+    return x;
+}
+
+iterator nth_element(List *this, size_t n)
+{
+    size_t size = distance(cbegin(this), cend(this));
+    if (n >= size)
+        return end(this);
+
+    iterator iter = begin(this);
+    if (this->sorted)
+    {
+        for (; n; --n)
+            iter.current = iter.current->pNext;
+        return iter;
+    }
+
+    // The segment being partitioned lies between a finished prefix and a finished suffix.
+    Node *prefix_last = &this->before_head;
+    Node *segment = this->head;
+    Chain suffix = {NULL, NULL};
+    size_t length = size;
+    uint64_t state = 0x9E3779B97F4A7C15ull ^ size;
+
+    for (;;)
+    {
+        Node *pivot = segment;
+        for (size_t steps = (size_t)(next_random(&state) % length); steps; --steps)
+            pivot = pivot->pNext;
+        int value = pivot->value;
+
+        // Three-way partition into chains that keep the original order.
+        Node less, equal, greater;
+        Node *less_last = &less, *equal_last = &equal, *greater_last = &greater;
+        size_t less_count = 0, equal_count = 0;
+        for (Node *p = segment; p != NULL; p = p->pNext)
+        {
+            if (p->value < value)
+            {
+                less_last->pNext = p;
+                less_last = p;
+                ++less_count;
+            }
+            else if (p->value == value)
+            {
+                equal_last->pNext = p;
+                equal_last = p;
+                ++equal_count;
+            }
+            else
+            {
+                greater_last->pNext = p;
+                greater_last = p;
+            }
+        }
+        less_last->pNext = equal_last->pNext = greater_last->pNext = NULL;
+
+        Chain lower = {less_count ? less.pNext : NULL, less_last};
+        Chain middle = {equal.pNext, equal_last};
+        Chain upper = {greater_last != &greater ? greater.pNext : NULL, greater_last};
+
+        if (n < less_count)
+        {
+            prepend_chain(&suffix, upper);
+            prepend_chain(&suffix, middle);
+            segment = lower.first;
+            length = less_count;
+            continue;
+        }
+
+        // The pivot run is final, and so is everything below it.
+        prepend_chain(&middle, lower);
+        prefix_last->pNext = middle.first;
+        prefix_last = middle.last;
+
+        if (n < less_count + equal_count)
+        {
+            prepend_chain(&suffix, upper);
+            prefix_last->pNext = suffix.first;
+            this->tail = suffix.first ? suffix.last : prefix_last;
+
+            iter.current = equal.pNext;
+            for (n -= less_count; n; --n)
+                iter.current = iter.current->pNext;
+            break;
+        }
+
+        n -= less_count + equal_count;
+        segment = upper.first;
+        length -= less_count + equal_count;
+    }
+
+    this->sorted = 0;
+    modified(this);
+    return iter;
+}
+
 int is_sorted(const_iterator first, const_iterator last)
 {
     if (!first.current)
@@ -360,52 +1263,246 @@ int is_sorted(const_iterator first, const_iterator last)
 
 void splice_after(iterator pos, List *other)
 {
-    Node *current = pos.current;
-    Node *next = pos.current->pNext;
+    splice_after_range(pos, other, before_begin(other), end(other));
+}
+
+void splice_after_one(iterator pos, List *other, iterator it)
+{
+    assert(pos.owner);
 
-    current->pNext = other->head;
+    Node *moved = it.current->pNext;
+    if (pos.current == it.current || pos.current == moved)
+        return;
 
-    Node *p = other->head;
-    while (p->pNext)
-        p = p->pNext;
+    it.current->pNext = moved->pNext;
+    if (other->tail == moved)
+        other->tail = it.current;
 
-    p->pNext = next;
+    Node *moved_last = moved;
+    moved = adoptChain(pos.owner, other, moved, &moved_last);
 
-    other->head = NULL;
+    moved->pNext = pos.current->pNext;
+    pos.current->pNext = moved;
+    if (pos.owner->tail == pos.current)
+        pos.owner->tail = moved;
+    pos.owner->sorted = 0;
+    modified(pos.owner);
+    modified(other);
 }
 
-void swap(List *this, List *other)
+void splice_after_range(iterator pos, List *other, iterator first, iterator last)
 {
-    List temp;
-    temp.head = this->head;
+    assert(pos.owner);
 
-    this->head = other->head;
+    Node *range_first = first.current->pNext;
+    if (range_first == last.current)
+        return;
 
-    other->head = temp.head;
+    Node *range_last;
+    if (!last.current)
+        range_last = other->tail;
+    else
+    {
+        range_last = range_first;
+        while (range_last->pNext != last.current)
+            range_last = range_last->pNext;
+    }
+
+    first.current->pNext = last.current;
+    if (!last.current)
+        other->tail = first.current;
+
+    range_first = adoptChain(pos.owner, other, range_first, &range_last);
+
+    range_last->pNext = pos.current->pNext;
+    pos.current->pNext = range_first;
+    if (pos.owner->tail == pos.current)
+        pos.owner->tail = range_last;
+    pos.owner->sorted = 0;
+    modified(pos.owner);
+    modified(other);
+}
+
+void swap(List *this, List *other)
+{
+    List temp = *this;
+    List other_fields = *other;
+
+    // The node allocator travels with the nodes it allocated. The allocator of each List structure, the
+    // versions and the indexes stay with the structures.
+    *this = *other;
+    this->list_free_fn = temp.list_free_fn;
+    this->list_ctx = temp.list_ctx;
+    this->version = temp.version + 1;
+    this->skip_index = temp.skip_index;
+    this->hash_index = temp.hash_index;
+    this->segment_index = temp.segment_index;
+    if (other->tail == &other->before_head)
+        this->tail = &this->before_head;
+
+    *other = temp;
+    other->list_free_fn = other_fields.list_free_fn;
+    other->list_ctx = other_fields.list_ctx;
+    other->version = other_fields.version + 1;
+    other->skip_index = other_fields.skip_index;
+    other->hash_index = other_fields.hash_index;
+    other->segment_index = other_fields.segment_index;
+    if (temp.tail == &this->before_head)
+        other->tail = &other->before_head;
 }
 
 void unique(List *this)
 {
     Node *first = this->head;
-    Node *after = this->head->pNext;
 
-    while (after)
+    while (first && first->pNext)
     {
+        Node *after = first->pNext;
         if (first->value != after->value)
         {
-            first = first->pNext;
-            after = after->pNext;
+            first = after;
+            continue;
         }
-        else
+
+        first->pNext = after->pNext;
+        destroyNode(this, after);
+    }
+
+    this->tail = first ? first : &this->before_head;
+    modified(this);
+}
+
+static void release_seen(void *arg)
+{
+    SeenSet *set = (SeenSet *)arg;
+    free(set->values);
+    free(set->stamps);
+    set->values = NULL;
+    set->stamps = NULL;
+    set->bits = 0;
+}
+
+static void create_seen_key(void)
+{
+    pthread_key_create(&seen_key, release_seen);
+}
+
+// Empties the set of the calling thread and makes room for "count" values at most half full.
+static void reset_seen(size_t count)
+{
+    unsigned bits = 4;
+    while (((size_t)1 << bits) < 2 * count)
+        ++bits;
+
+    if (bits > seen.bits)
+    {
+        if (!seen.stamps)
+        {
+            // Frees the set when the thread exits.
+            pthread_once(&seen_key_once, create_seen_key);
+            pthread_setspecific(seen_key, &seen);
+        }
+
+        free(seen.values);
+        free(seen.stamps);
+        seen.values = (int *)malloc(((size_t)1 << bits) * sizeof(int));
+        seen.stamps = (unsigned *)calloc((size_t)1 << bits, sizeof(unsigned));
+        if (!seen.values || !seen.stamps)
+        {
+            fprintf(stderr, "Allocation failed");
+            exit(EXIT_FAILURE);
+        }
+        seen.bits = bits;
+        seen.stamp = 0;
+    }
+
+    if (++seen.stamp == 0)
+    {
+        for (size_t i = 0; i < ((size_t)1 << seen.bits); ++i)
+            seen.stamps[i] = 0;
+        seen.stamp = 1;
+    }
+}
+
+// Adds "value" to the set. Returns false(0) if it was already there.
+static int insert_seen(int value)
+{
+    size_t mask = ((size_t)1 << seen.bits) - 1;
+    size_t i = (size_t)(((uint64_t)(unsigned)value * 0x9E3779B97F4A7C15ull) >> (64 - seen.bits));
+
+    while (seen.stamps[i] == seen.stamp)
+    {
+        if (seen.values[i] == value)
+            return 0;
+        i = (i + 1) & mask;
+    }
+
+    seen.stamps[i] = seen.stamp;
+    seen.values[i] = value;
+    return 1;
+}
+
+size_t unique_all(List *this)
+{
+    // In a sorted list equal elements are adjacent, so no set is needed.
+    int sorted = this->sorted;
+    if (!sorted)
+        reset_seen(distance(cbegin(this), cend(this)));
+
+    Node *prev = &this->before_head;
+    Node removed;
+    Node *removed_last = &removed;
+    size_t count = 0;
+
+    while (prev->pNext)
+    {
+        Node *p = prev->pNext;
+        int first = sorted ? prev == &this->before_head || prev->value != p->value : insert_seen(p->value);
+        if (first)
         {
-            Node *temp = after;
-            first->pNext = after->pNext;
-            if (!after && after->pNext->value != first->value)
-                first = after->pNext;
-            after = first->pNext;
-            free(temp);
+            prev = p;
+            continue;
         }
+
+        prev->pNext = p->pNext;
+        removed_last->pNext = p;
+        removed_last = p;
+        ++count;
     }
+
+    this->tail = prev;
+    if (count)
+    {
+        removed_last->pNext = NULL;
+        destroyRange(this, removed.pNext, NULL);
+        modified(this);
+    }
+
+    return count;
+}
+
+int list_migrate(List *this, int numa_node)
+{
+    if (this->alloc_fn || numa_node < 0 || numa_node >= NODE_POOL_MAX_NUMA_NODES)
+        return -1;
+    if (empty(this))
+        return 0;
+
+    Node *tail;
+    Node *chain = node_pool_alloc_chain_on(numa_node, distance(cbegin(this), cend(this)), &tail);
+    if (!chain)
+        return -1;
+
+    Node *q = chain;
+    for (const Node *p = this->head; p != NULL; p = p->pNext, q = q->pNext)
+        q->value = p->value;
+
+    destroyRange(this, this->head, NULL);
+    this->head = chain;
+    this->tail = tail;
+    modified(this);
+
+    return 0;
 }
 
 // Global Functions
@@ -455,6 +1552,14 @@ iterator find(iterator first, iterator last, int value)
     return last;
 }
 
+const_iterator lower_bound(const_iterator first, const_iterator last, int value)
+{
+    while (first.current != last.current && first.current->value < value)
+        const_next(&first);
+
+    return first;
+}
+
 const_iterator cfind(const_iterator first, const_iterator last, int value)
 {
     while (first.current != last.current)
@@ -466,22 +1571,108 @@ const_iterator cfind(const_iterator first, const_iterator last, int value)
     return last;
 }
 
+// List View Functions
+
+ListView make_view(const int *arr, size_t size)
+{
+    ListView view;
+    view.data = arr;
+    view.size = size;
+    view.owned = NULL;
+
+    return view;
+}
+
+void destroy_view(ListView *view)
+{
+    if (view->owned)
+        destroy_list(view->owned);
+
+    view->owned = NULL;
+}
+
+List *view_mutable(ListView *view)
+{
+    if (!view->owned)
+        view->owned = to_forward_list(view->data, view->size);
+
+    return view->owned;
+}
+
+view_iterator view_cbegin(const ListView *view)
+{
+    view_iterator iter;
+    iter.current = view->data;
+
+    return iter;
+}
+
+view_iterator view_cend(const ListView *view)
+{
+    view_iterator iter;
+    iter.current = view->data + view->size;
+
+    return iter;
+}
+
+void view_next(view_iterator *iter)
+{
+    ++iter->current;
+}
+
+size_t view_distance(view_iterator first, view_iterator last)
+{
+    return (size_t)(last.current - first.current);
+}
+
+view_iterator view_find(view_iterator first, view_iterator last, int value)
+{
+    while (first.current != last.current)
+    {
+        if (*first.current == value)
+            return first;
+        ++first.current;
+    }
+    return last;
+}
+
+int view_is_sorted(view_iterator first, view_iterator last)
+{
+    if (first.current == last.current)
+        return 1;
+
+    for (const int *p = first.current + 1; p != last.current; ++p)
+        if (p[-1] > *p)
+            return 0;
+
+    return 1;
+}
+
 //  Utility Functions
 
 void random_fill(List *this, size_t size)
 {
-    while (size--)
-        push_front(this, rand() % 100);
+    if (!size)
+        return;
+
+    Node *tail;
+    Node *chain = createChain(this, size, &tail);
+    for (Node *p = chain; p != NULL; p = p->pNext)
+        p->value = rand() % 100;
+
+    tail->pNext = this->head;
+    if (!this->head)
+        this->tail = tail;
+    this->head = chain;
+    this->sorted = 0;
+    modified(this);
 }
 
 void print_list(List *this)
 {
     if (!empty(this))
     {
-        for (Node *p = this->head; p != NULL; p = p->pNext)
-            printf("%d -> ", (p->value));
-
-        printf("NULL\n");
+        list_write_text(this, stdout);
         return;
     }
 
@@ -490,12 +1681,183 @@ void print_list(List *this)
 
 void print_list_iterator(const_iterator first, const_iterator last)
 {
+    list_write_text_iterator(first, last, stdout);
+}
+
+static char *format_int(char *out, int value)
+{
+    char digits[10];
+    unsigned magnitude = value < 0 ? 0u - (unsigned)value : (unsigned)value;
+    int count = 0;
+
+    do
+    {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+
+    if (value < 0)
+        *out++ = '-';
+    while (count)
+        *out++ = digits[--count];
+
+    return out;
+}
+
+int list_write_text(List *this, FILE *stream)
+{
+    return list_write_text_iterator(cbegin(this), cend(this), stream);
+}
+
+int list_write_text_iterator(const_iterator first, const_iterator last, FILE *stream)
+{
+    static const char arrow[] = " -> ";
+    static const char terminator[] = "NULL\n";
+    char buffer[TEXT_BUFFER_SIZE];
+    char *out = buffer;
+
     while (first.current != last.current)
     {
-        printf("%d -> ", (first.current->value));
+        // Room for the longest element, 11 characters for INT_MIN, its arrow and the terminator after the last one.
+        if ((size_t)(buffer + sizeof(buffer) - out) < 11 + sizeof(arrow) - 1 + sizeof(terminator) - 1)
+        {
+            if (fwrite(buffer, 1, (size_t)(out - buffer), stream) != (size_t)(out - buffer))
+                return -1;
+            out = buffer;
+        }
+
+        out = format_int(out, first.current->value);
+        for (size_t i = 0; i < sizeof(arrow) - 1; ++i)
+            *out++ = arrow[i];
         const_next(&first);
     }
-    printf("NULL\n");
+
+    for (size_t i = 0; i < sizeof(terminator) - 1; ++i)
+        *out++ = terminator[i];
+
+    if (fwrite(buffer, 1, (size_t)(out - buffer), stream) != (size_t)(out - buffer))
+        return -1;
+
+    return 0;
+}
+
+List *list_read_text(FILE *stream)
+{
+    enum
+    {
+        EXPECT_VALUE,
+        IN_SIGN,
+        IN_NUMBER,
+        EXPECT_ARROW,
+        IN_ARROW,
+        IN_NULL,
+        DONE
+    } state = EXPECT_VALUE;
+
+    static const char terminator[] = "NULL";
+    char buffer[TEXT_BUFFER_SIZE];
+    List *this = create_list();
+    Node *last = &this->before_head;
+    int negative = 0;
+    unsigned long long magnitude = 0;
+    size_t matched = 0;
+    int failed = 0;
+    size_t length;
+
+    while (!failed && (length = fread(buffer, 1, sizeof(buffer), stream)) > 0)
+    {
+        for (size_t i = 0; i < length && !failed; ++i)
+        {
+            char c = buffer[i];
+            int digit = c >= '0' && c <= '9';
+            int space = c == ' ' || c == '\n' || c == '\t' || c == '\r';
+
+            switch (state)
+            {
+            case EXPECT_VALUE:
+                if (digit)
+                {
+                    negative = 0;
+                    magnitude = (unsigned long long)(c - '0');
+                    state = IN_NUMBER;
+                }
+                else if (c == '-')
+                    state = IN_SIGN;
+                else if (c == terminator[0])
+                {
+                    matched = 1;
+                    state = IN_NULL;
+                }
+                else
+                    failed = !space;
+                break;
+
+            case IN_SIGN:
+                negative = 1;
+                magnitude = (unsigned long long)(c - '0');
+                state = IN_NUMBER;
+                failed = !digit;
+                break;
+
+            case IN_NUMBER:
+                if (digit)
+                {
+                    magnitude = magnitude * 10 + (unsigned long long)(c - '0');
+                    failed = magnitude > (unsigned long long)INT_MAX + negative;
+                    break;
+                }
+
+                Node *pNewNode = createNode(this);
+                pNewNode->value = negative ? -(int)(magnitude - 1) - 1 : (int)magnitude;
+                if (last != &this->before_head && last->value > pNewNode->value)
+                    this->sorted = 0;
+                last->pNext = pNewNode;
+                last = pNewNode;
+
+                if (c == '-')
+                    state = IN_ARROW;
+                else
+                {
+                    state = EXPECT_ARROW;
+                    failed = !space;
+                }
+                break;
+
+            case EXPECT_ARROW:
+                if (c == '-')
+                    state = IN_ARROW;
+                else
+                    failed = !space;
+                break;
+
+            case IN_ARROW:
+                state = EXPECT_VALUE;
+                failed = c != '>';
+                break;
+
+            case IN_NULL:
+                failed = c != terminator[matched];
+                if (++matched == sizeof(terminator) - 1)
+                    state = DONE;
+                break;
+
+            case DONE:
+                failed = !space;
+                break;
+            }
+        }
+    }
+
+    last->pNext = NULL;
+    this->tail = last;
+
+    if (failed || state != DONE || ferror(stream))
+    {
+        destroy_list(this);
+        return NULL;
+    }
+
+    return this;
 }
 
 void print_size(List *this)
@@ -525,11 +1887,10 @@ int *to_array(List *this)
     return arr;
 }
 
-List *to_forward_list(int *arr, size_t size)
+List *to_forward_list(const int *arr, size_t size)
 {
     List *this = create_list();
-    for (size_t i = size - 1; i > 0; --i)
-        push_front(this, arr[i]);
+    assign_array(this, arr, size);
 
     return this;
 }
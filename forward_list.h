@@ -4,6 +4,11 @@
 #define FORWARD_LIST_H
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define MERGE_MANY_WAYS 128
+#define REMOVE_BATCH_SIZE 256
 
 typedef struct Node
 {
@@ -11,14 +16,46 @@ typedef struct Node
     struct Node *pNext;
 } Node;
 
+// before_head is the sentinel node returned by before_begin(); its link is the head of the list.
+// tail is the last node, or the sentinel if the list is empty.
+// alloc_fn and free_fn are the allocator of the nodes, or NULL for the shared node pool. list_free_fn and
+// list_ctx release the List structure itself; unlike the node allocator they do not move with swap().
+// version is incremented by every function that changes the list, so that side indexes can tell when
+// they are out of date. sorted is true(1) while the elements are known to be in non-descending order.
+// Writing to elements through iterators updates neither; invalidate() does.
+// skip_index, hash_index and segment_index are the indexes attached by skip_index_attach(),
+// hash_index_attach() and segment_index_attach(), or NULL.
 typedef struct List
 {
-    Node *head;
+    union
+    {
+        Node before_head;
+        struct
+        {
+            int reserved;
+            Node *head;
+        };
+    };
+    Node *tail;
+    void *(*alloc_fn)(size_t size, void *ctx);
+    void (*free_fn)(void *ptr, void *ctx);
+    void *alloc_ctx;
+    void (*list_free_fn)(void *ptr, void *ctx);
+    void *list_ctx;
+    unsigned long version;
+    int sorted;
+    struct SkipIndex *skip_index;
+    struct HashIndex *hash_index;
+    struct SegmentIndex *segment_index;
 } List;
 
+// owner is the list the iterator was obtained from. The functions that change a list through an iterator,
+// insert_after, erase_after, erase_after_range and the splice functions, need it to keep the tail and the
+// rest of the bookkeeping of the list; passing an iterator without an owner is an error.
 typedef struct iterator
 {
     Node *current;
+    List *owner;
 } iterator;
 
 typedef struct const_iterator
@@ -26,13 +63,46 @@ typedef struct const_iterator
     const Node *current;
 } const_iterator;
 
+// A read-only view of a contiguous int array. The elements are not copied until the view is mutated.
+typedef struct ListView
+{
+    const int *data;
+    size_t size;
+    List *owned;
+} ListView;
+
+typedef struct view_iterator
+{
+    const int *current;
+} view_iterator;
+
 List *create_list(void);
 void destroy_list(List *this);
 
+// Creates a list whose structure and nodes are allocated with "alloc_fn" and released with "free_fn".
+// "ctx" is passed to both and travels with the list; swap() exchanges it along with the elements.
+// Elements moved in from a list with another allocator by merge or splice_after are copied.
+// Lists created with create_list() use the shared node pool.
+List *create_list_with_allocator(void *(*alloc_fn)(size_t size, void *ctx), void (*free_fn)(void *ptr, void *ctx),
+                                 void *ctx);
+
 // Replaces the contents of the container with "count" copies of value "value".
 // All iterators and pointers to the elements of the container are invalidated.
 void assign(List *this, size_t count, int value);
 
+// Replaces the contents of the container with copies of the "size" elements of "arr".
+void assign_array(List *this, const int *arr, size_t size);
+
+// Returns an iterator to the element before the first element of the container.
+// This element acts as a placeholder, attempting to access it results in undefined behavior.
+// It can be passed to insert_after, erase_after and splice_after to work on the front of the list.
+iterator before_begin(List *this);
+const_iterator cbefore_begin(List *this);
+
+// Returns an iterator to the last element of the container, or before_begin() if it is empty.
+// Runs in constant time, so splice_after(before_end(this), other) appends without traversal.
+iterator before_end(List *this);
+
 // Returns an iterator to the first element of the forward_list.
 // If the forward_list is empty, the returned iterator will be equal to end().
 iterator begin(List *this);
@@ -56,21 +126,50 @@ const_iterator cend(List *this);
 // Returns iterator to the element following the erased one, or end() if no such element exists.
 iterator erase_after(iterator pos);
 
+// Removes the elements in the range (first, last).
+// The erased nodes are unlinked and released as one batch in O(1), without being walked.
+// Returns last.
+iterator erase_after_range(iterator first, iterator last);
+
 // Returns a pointer to the first element in the container.
 // Calling front on an empty container causes undefined behavior.
+// Since the element may be written through the pointer, the list is invalidated as by invalidate().
+// Use cfront to read the element without that cost.
 int *front(List *this);
 
+// Returns a pointer to the first element in the container, for reading only.
+// Calling cfront on an empty container causes undefined behavior.
+const int *cfront(const List *this);
+
+// Tells the list that elements were written through pointers or iterators: it is no longer known to be
+// sorted, and attached indexes are rebuilt on their next use.
+void invalidate(List *this);
+
 // Inserts "value" after the element pointed to by "pos"
 // No iterators are invalidated.
 // Returns iterator to the inserted element.
-// The behavior is undefined if list has no elements.
+// Use before_begin() to insert at the front, including into an empty list.
 iterator insert_after(iterator pos, int value);
 
+// Inserts "value" after the elements that are not greater than it, keeping the list sorted.
+// The list is sorted first if it is not known to be sorted. Returns iterator to the inserted element.
+// Constant time when "value" goes at the end, linear in the position of the new element otherwise.
+iterator insert_sorted(List *this, int value);
+
 // The function does nothing if "other" refers to the same object as "this".
 // Otherwise, merges two sorted lists into one. The lists should be sorted into ascending order.
 // No elements are copied, and the container other becomes empty after the merge.
+// Links are only rewritten where the merged order switches lists, and lists whose ranges do not overlap
+// are concatenated in constant time.
 void merge(List *this, List *other);
 
+// Merges the "k" sorted lists in "srcs" into the sorted list "dst" in one pass over all elements, using a
+// binary heap of the list heads. Equal elements keep the order of their lists, "dst" first, then "srcs"
+// in order. Nodes are relinked, not copied, and every list in "srcs" becomes empty.
+// Needs no memory of its own for up to MERGE_MANY_WAYS - 1 sources; for more, the heap is allocated once.
+// Entries of "srcs" equal to "dst" are skipped.
+void merge_many(List *dst, List **srcs, size_t k);
+
 // Removes the first element of the container. If there are no elements in the container, the behavior is undefined.
 // Iterators to the erased element are invalidated.
 void pop_front(List *this);
@@ -81,24 +180,59 @@ void push_front(List *this, int value);
 
 // Removes all elements that are equal to "value".
 // Returns the number of elements removed.
+// With a hash index attached, runs in time proportional to the number of elements removed.
 int remove_(List *this, int value);
 
 // Removes all elements for which predicate "unPred" returns true.
 // Returns the number of elements removed.
 int remove_if(List *this, int (*unPred)(const int *value));
 
+// Same as remove_if, but the predicate sees the values REMOVE_BATCH_SIZE at a time: "pred" sets mask[i] to
+// non-zero for each of the "n" values in "values" to remove. The values are gathered into a contiguous
+// buffer, so the predicate can be vectorized, and matching nodes are unlinked a run at a time and
+// released as one batch. Returns the number of elements removed.
+int remove_if_batch(List *this, void (*pred)(const int *values, size_t n, uint8_t *mask));
+
+// Returns the number of elements equal to "value", and whether there is one.
+// Constant time with a hash index attached, linear otherwise.
+size_t count(List *this, int value);
+int contains(List *this, int value);
+
 // Resizes the container to contain "count" elements, does nothing if count == size().
 // If the current size is greater than "count", the container is reduced to its first "count" elements.
 // If the current size is less than "count", additional zeroes are appended
+// Walks the list once, then releases the cut elements as one batch or links all new elements at once.
 void resize(List *this, size_t count);
 void resize_value(List *this, size_t count, int value);
 
 // Reverses the order of the elements in the container. No iterators become invalidated.
+// With a segment index attached, segments are reversed in parallel and then stitched together.
 void reverse(List *this);
 
 // Sorts the elements in ascending order. The order of equal elements is preserved.
+// Returns in constant time if the list is known to be sorted; call invalidate() after writing elements
+// through iterators so that it is not.
 void sort(List *this);
 
+// Sorts the elements in the order defined by "cmp", which returns a negative value, zero or a positive value
+// if "a" goes before, next to or after "b". The order of equal elements is preserved.
+void sort_by(List *this, int (*cmp)(int a, int b));
+
+// Sorts the elements by ascending key, calling "key_fn" once per element. The keys are kept in a scratch
+// buffer while sorting. The order of elements with equal keys is preserved. The list may hold at most
+// INT_MAX elements.
+void sort_by_key(List *this, long long (*key_fn)(int value));
+
+// Moves the "k" smallest elements to the front of the list in ascending order, in O(n log k) with a bounded
+// heap of k nodes. The order of the other elements, which follow, is unspecified.
+void partial_sort(List *this, size_t k);
+
+// Relinks the list so that the element at position "n" is the one that would be there if the list were
+// sorted, no element before it is greater and no element after it is less. Runs in expected linear time
+// by partitioning the nodes around random pivots. Returns an iterator to that element, or end if "n" is
+// not less than the size of the list.
+iterator nth_element(List *this, size_t n);
+
 // Checks if the elements in range [first, last) are sorted in non-descending order.
 int is_sorted(const_iterator first, const_iterator last);
 
@@ -107,16 +241,37 @@ int is_sorted(const_iterator first, const_iterator last);
 // The elements are inserted after the element pointed to by pos.
 // The container other becomes empty after the operation.
 // The behavior is undefined if other refers to the same object as *this.
+// Runs in constant time, as every list keeps track of its tail.
 void splice_after(iterator pos, List *other);
 
+// Moves the element following "it" in other to "this", after the element pointed to by pos.
+// Does nothing if pos == it or pos == ++it.
+void splice_after_one(iterator pos, List *other, iterator it);
+
+// Moves the elements in the range (first, last) of other to "this", after the element pointed to by pos.
+// Constant time when last is end(other), linear in the length of the range otherwise.
+// The behavior is undefined if pos is an iterator in the range (first, last).
+void splice_after_range(iterator pos, List *other, iterator first, iterator last);
+
 // Exchanges the contents of the container with those of "other".
-// Does not invoke any move, copy, or swap operations on individual elements.
+// Does not invoke any move, copy, or swap operations on individual elements. The node allocators are
+// exchanged along with the nodes; each List structure keeps the allocator that created it.
 void swap(List *this, List *other);
 
 // Removes all consecutive duplicate elements from the container.
 // Only the first element in each group of equal elements is left.
 void unique(List *this);
 
+// Removes every element that is equal to an earlier one, keeping first occurrences in their order.
+// Runs in one pass, with a hash set that is kept per thread and reused by later calls unless the list is
+// known to be sorted, and releases the removed nodes as one batch. Returns the number of elements removed.
+size_t unique_all(List *this);
+
+// Moves the elements to fresh nodes on NUMA node "numa_node", laid out contiguously in list order.
+// Iterators into the list are invalidated. Returns 0 on success, -1 if the list uses its own allocator
+// or the nodes cannot be placed on "numa_node", in which case the list is left unchanged.
+int list_migrate(List *this, int numa_node);
+
 // Global Functions
 
 // Increments given iterator "iter" by "n" elements. n must be greater or equal to 0.
@@ -134,14 +289,48 @@ void const_next(const_iterator *iter);
 iterator find(iterator first, iterator last, int value);
 const_iterator cfind(const_iterator first, const_iterator last, int value);
 
+// Returns an iterator to the first element in the sorted range [first, last) that is not less than "value",
+// or last if there is no such element. Stops at the first such element instead of scanning the whole range.
+const_iterator lower_bound(const_iterator first, const_iterator last, int value);
+
+// List View Functions
+
+// Creates a view of the "size" elements of "arr" without allocating. "arr" must outlive the view.
+ListView make_view(const int *arr, size_t size);
+
+// Releases the list owned by the view, if it has been mutated.
+void destroy_view(ListView *view);
+
+// Returns a list holding the elements of the view for mutation. The list is built on the first call
+// and returned by every later call. View iterators keep reading the original array.
+List *view_mutable(ListView *view);
+
+// Same as the const_iterator functions of the same name, walking the array directly.
+view_iterator view_cbegin(const ListView *view);
+view_iterator view_cend(const ListView *view);
+void view_next(view_iterator *iter);
+size_t view_distance(view_iterator first, view_iterator last);
+view_iterator view_find(view_iterator first, view_iterator last, int value);
+int view_is_sorted(view_iterator first, view_iterator last);
+
 //  Utility Functions
 
 void random_fill(List *this, size_t size);
 void print_list(List *this);
 void print_list_iterator(const_iterator begin, const_iterator end);
 void print_size(List *this);
+
+// Writes the elements to "stream" in the "1 -> 2 -> NULL" format of print_list, followed by a newline.
+// Values are formatted into a large buffer that is written in bulk.
+// Returns 0 on success, -1 on a write error.
+int list_write_text(List *this, FILE *stream);
+int list_write_text_iterator(const_iterator first, const_iterator last, FILE *stream);
+
+// Reads a list in the format written by list_write_text, linking each node as its value is parsed.
+// Returns NULL if the input is malformed or a value does not fit in an int.
+List *list_read_text(FILE *stream);
 void randomize(void);
 int *to_array(List *this);
-List *to_forward_list(int *arr, size_t size);
+List *to_forward_list(const int *arr, size_t size);
 
 #endif // FORWARD_LIST_H
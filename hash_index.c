@@ -0,0 +1,330 @@
+#include "hash_index.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HASH_INDEX_MIN_BITS 4
+#define HASH_INDEX_NONE SIZE_MAX
+
+// Static Functions
+
+static void *allocate(size_t size)
+{
+    void *memory = malloc(size);
+    if (!memory)
+    {
+        fprintf(stderr, "Allocation failed");
+        exit(EXIT_FAILURE);
+    }
+
+    return memory;
+}
+
+// Fibonacci hashing; the top bits of the product are the best mixed.
+static size_t hash(uint64_t key, unsigned bits)
+{
+    return (size_t)((key * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+}
+
+static HashSlot *claim_slot(HashIndex *index, int value)
+{
+    size_t mask = ((size_t)1 << index->bits) - 1;
+    size_t i = hash((uint64_t)(unsigned)value, index->bits);
+
+    while (index->slots[i].used && index->slots[i].value != value)
+        i = (i + 1) & mask;
+
+    HashSlot *slot = &index->slots[i];
+    if (!slot->used)
+    {
+        ++index->slots_used;
+        slot->used = 1;
+        slot->value = value;
+        slot->count = 0;
+    }
+
+    return slot;
+}
+
+static HashSlot *find_slot(const HashIndex *index, int value)
+{
+    size_t mask = ((size_t)1 << index->bits) - 1;
+    size_t i = hash((uint64_t)(unsigned)value, index->bits);
+
+    while (index->slots[i].used)
+    {
+        if (index->slots[i].value == value)
+            return &index->slots[i];
+        i = (i + 1) & mask;
+    }
+
+    return NULL;
+}
+
+static size_t *node_slot(HashIndex *index, const Node *node)
+{
+    size_t mask = ((size_t)1 << index->bits) - 1;
+    size_t i = hash((uint64_t)(uintptr_t)node, index->bits);
+
+    while (index->nodes[i] != HASH_INDEX_NONE && index->entries[index->nodes[i]].node != node)
+        i = (i + 1) & mask;
+
+    return &index->nodes[i];
+}
+
+static void build(HashIndex *index)
+{
+    List *list = index->list;
+    size_t size = distance(cbegin(list), cend(list));
+
+    // Tables start at most a quarter full, even if every value is distinct, so that as many elements again
+    // can be inserted before they are half full and the next build is needed.
+    unsigned bits = HASH_INDEX_MIN_BITS;
+    while (((size_t)1 << bits) < 4 * size)
+        ++bits;
+
+    if (index->entries_capacity < size)
+    {
+        free(index->entries);
+        index->entries = (HashEntry *)allocate(size * sizeof(HashEntry));
+        index->entries_capacity = size;
+    }
+    if (!index->slots || bits > index->bits)
+    {
+        free(index->slots);
+        free(index->nodes);
+        index->slots = (HashSlot *)allocate(((size_t)1 << bits) * sizeof(HashSlot));
+        index->nodes = (size_t *)allocate(((size_t)1 << bits) * sizeof(size_t));
+        index->bits = bits;
+    }
+
+    for (size_t i = 0; i < ((size_t)1 << index->bits); ++i)
+    {
+        index->slots[i].used = 0;
+        index->nodes[i] = HASH_INDEX_NONE;
+    }
+
+    index->size = 0;
+    index->slots_used = 0;
+    Node *pred = &list->before_head;
+    for (Node *p = list->head; p != NULL; pred = p, p = p->pNext)
+    {
+        size_t e = index->size++;
+        index->entries[e].node = p;
+        index->entries[e].pred = pred;
+        index->entries[e].next = HASH_INDEX_NONE;
+
+        HashSlot *slot = claim_slot(index, p->value);
+        index->entries[e].prev = slot->count ? slot->last : HASH_INDEX_NONE;
+        if (slot->count++)
+            index->entries[slot->last].next = e;
+        else
+            slot->first = e;
+        slot->last = e;
+
+        *node_slot(index, p) = e;
+    }
+
+    index->version = list->version;
+}
+
+// Links entry "e" into the entries of "slot" before entry "before", or last if it is HASH_INDEX_NONE.
+static void link_entry(HashIndex *index, HashSlot *slot, size_t e, size_t before)
+{
+    HashEntry *entry = &index->entries[e];
+    entry->next = before;
+    entry->prev = before != HASH_INDEX_NONE ? index->entries[before].prev : slot->count ? slot->last : HASH_INDEX_NONE;
+
+    if (entry->prev != HASH_INDEX_NONE)
+        index->entries[entry->prev].next = e;
+    else
+        slot->first = e;
+    if (before != HASH_INDEX_NONE)
+        index->entries[before].prev = e;
+    else
+        slot->last = e;
+
+    ++slot->count;
+}
+
+static void unlink_entry(HashIndex *index, HashSlot *slot, size_t e)
+{
+    const HashEntry *entry = &index->entries[e];
+
+    if (entry->prev != HASH_INDEX_NONE)
+        index->entries[entry->prev].next = entry->next;
+    else
+        slot->first = entry->next;
+    if (entry->next != HASH_INDEX_NONE)
+        index->entries[entry->next].prev = entry->prev;
+    else
+        slot->last = entry->prev;
+
+    --slot->count;
+}
+
+// Returns true(1) if the only change to the list since the index was up to date is the one being reported.
+static int follows_one_change(const HashIndex *index)
+{
+    return index->version + 1 == index->list->version;
+}
+
+// Rebuilds the tables if the list has been changed behind the back of the index.
+static void refresh(HashIndex *index)
+{
+    if (index->version != index->list->version)
+        build(index);
+}
+
+HashIndex *hash_index_attach(List *list)
+{
+    if (list->hash_index)
+        return list->hash_index;
+
+    HashIndex *index = (HashIndex *)allocate(sizeof(HashIndex));
+    index->list = list;
+    index->entries = NULL;
+    index->entries_capacity = 0;
+    index->slots = NULL;
+    index->nodes = NULL;
+    index->bits = 0;
+    build(index);
+
+    list->hash_index = index;
+    return index;
+}
+
+void hash_index_detach(List *list)
+{
+    HashIndex *index = list->hash_index;
+    if (!index)
+        return;
+
+    free(index->entries);
+    free(index->slots);
+    free(index->nodes);
+    free(index);
+    list->hash_index = NULL;
+}
+
+size_t hash_index_count(HashIndex *index, int value)
+{
+    refresh(index);
+
+    const HashSlot *slot = find_slot(index, value);
+    return slot ? slot->count : 0;
+}
+
+const_iterator hash_index_find(HashIndex *index, int value)
+{
+    refresh(index);
+
+    const HashSlot *slot = find_slot(index, value);
+    const_iterator iter;
+    iter.current = slot && slot->count ? index->entries[slot->first].node : NULL;
+
+    return iter;
+}
+
+size_t hash_index_remove(HashIndex *index, int value)
+{
+    refresh(index);
+
+    HashSlot *slot = find_slot(index, value);
+    if (!slot || !slot->count)
+        return 0;
+
+    size_t removed = slot->count;
+    iterator first;
+    iterator last;
+    first.owner = last.owner = index->list;
+
+    // Entries are in list order, so the entries of a run of adjacent matches follow each other.
+    size_t e = slot->first;
+    while (e != HASH_INDEX_NONE)
+    {
+        first.current = index->entries[e].pred;
+        last.current = first.current->pNext;
+        while (last.current && last.current->value == value)
+        {
+            last.current = last.current->pNext;
+            e = index->entries[e].next;
+        }
+
+        if (last.current)
+            index->entries[*node_slot(index, last.current)].pred = first.current;
+        erase_after_range(first, last);
+    }
+
+    slot->count = 0;
+
+    // The tables were kept up to date along with the list.
+    index->version = index->list->version;
+    return removed;
+}
+
+void hash_index_inserted(HashIndex *index, Node *pred, Node *node)
+{
+    if (!follows_one_change(index))
+        return;
+
+    // A node at the address of one released earlier reuses its entry and its slot in the node table.
+    // Past half full, leave the tables stale so that the next use rebuilds them larger. Value slots are
+    // not freed until then, so a value without one counts even if the entry is reused.
+    size_t table = (size_t)1 << index->bits;
+    size_t *reused = node_slot(index, node);
+    if (*reused == HASH_INDEX_NONE && 2 * (index->size + 1) > table)
+        return;
+    if (!find_slot(index, node->value) && 2 * (index->slots_used + 1) > table)
+        return;
+
+    if (*reused == HASH_INDEX_NONE && index->size == index->entries_capacity)
+    {
+        size_t capacity = index->entries_capacity ? 2 * index->entries_capacity : 16;
+        HashEntry *entries = (HashEntry *)realloc(index->entries, capacity * sizeof(HashEntry));
+        if (!entries)
+        {
+            fprintf(stderr, "Allocation failed");
+            exit(EXIT_FAILURE);
+        }
+        index->entries = entries;
+        index->entries_capacity = capacity;
+    }
+
+    size_t e = *reused != HASH_INDEX_NONE ? *reused : index->size++;
+    *reused = e;
+    index->entries[e].node = node;
+    index->entries[e].pred = pred;
+
+    // Entries of a value stay in list order: the new one goes before the next node holding the same value.
+    HashSlot *slot = claim_slot(index, node->value);
+    size_t before = HASH_INDEX_NONE;
+    if (slot->count && pred == &index->list->before_head)
+        before = slot->first;
+    else if (slot->count && node->pNext)
+    {
+        const Node *p = node->pNext;
+        while (p && p->value != node->value)
+            p = p->pNext;
+        if (p)
+            before = *node_slot(index, p);
+    }
+    link_entry(index, slot, e, before);
+
+    if (node->pNext)
+        index->entries[*node_slot(index, node->pNext)].pred = node;
+
+    index->version = index->list->version;
+}
+
+void hash_index_erased(HashIndex *index, Node *pred, Node *node)
+{
+    if (!follows_one_change(index))
+        return;
+
+    unlink_entry(index, find_slot(index, node->value), *node_slot(index, node));
+    if (pred->pNext)
+        index->entries[*node_slot(index, pred->pNext)].pred = pred;
+
+    index->version = index->list->version;
+}
@@ -0,0 +1,70 @@
+// Hash index over the values of a list.
+
+#ifndef HASH_INDEX_H
+#define HASH_INDEX_H
+
+#include "forward_list.h"
+#include <stddef.h>
+
+// Maps each value to the predecessors of the nodes holding it, in list order, with open addressing.
+// A second table maps nodes back to their entries, so that unlinking a run of matches can fix up the
+// predecessor of the node after it in O(1).
+typedef struct HashEntry
+{
+    Node *node;
+    Node *pred;
+    size_t prev; // previous entry with the same value
+    size_t next; // next entry with the same value
+} HashEntry;
+
+typedef struct HashSlot
+{
+    int value;
+    int used;
+    size_t count;
+    size_t first;
+    size_t last;
+} HashSlot;
+
+typedef struct HashIndex
+{
+    List *list;
+    HashEntry *entries;
+    size_t size;
+    size_t entries_capacity;
+    HashSlot *slots;    // keyed by value
+    size_t slots_used;  // slots ever claimed since the last build; they are not freed in between
+    size_t *nodes;      // keyed by node address, entry numbers
+    unsigned bits;      // both tables have 1 << bits slots
+    unsigned long version; // version of the list the tables describe
+} HashIndex;
+
+// Builds a hash index over "list" in O(n) and attaches it, so that count(), contains() and remove_()
+// use it. Returns the index already attached, if any. insert_after() and erase_after(), and with them
+// push_front() and pop_front(), keep the index up to date. Changes made by other functions are detected
+// and the index is rebuilt on its next use. destroy_list() detaches the index.
+HashIndex *hash_index_attach(List *list);
+
+// Releases the index attached to "list", if any.
+void hash_index_detach(List *list);
+
+// Returns the number of elements equal to "value" in O(1).
+size_t hash_index_count(HashIndex *index, int value);
+
+// Returns an iterator to the first element equal to "value", or cend if there is none, in O(1).
+const_iterator hash_index_find(HashIndex *index, int value);
+
+// Removes all elements equal to "value" in time proportional to their number, unlinking each run of
+// adjacent matches at once, and returns the number of elements removed.
+size_t hash_index_remove(HashIndex *index, int value);
+
+// Called by insert_after() once "node" has been linked after "pred" and the change recorded. If the index
+// was up to date before the change, it is updated in O(1), except that a value already present elsewhere
+// in the list needs a walk to its next occurrence unless "node" goes to the front or the back.
+void hash_index_inserted(HashIndex *index, Node *pred, Node *node);
+
+// Called by erase_after() once "node" has been unlinked from after "pred" and the change recorded, but
+// before it is released. If the index was up to date before the change, it is updated in O(1).
+void hash_index_erased(HashIndex *index, Node *pred, Node *node);
+
+#endif // HASH_INDEX_H
@@ -0,0 +1,187 @@
+#define _DEFAULT_SOURCE
+
+#include "list_image.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef MAP_FIXED_NOREPLACE
+#define IMAGE_MAP_FLAGS (MAP_PRIVATE | MAP_FIXED_NOREPLACE)
+#else
+#define IMAGE_MAP_FLAGS MAP_PRIVATE
+#endif
+
+#define IMAGE_MAGIC "CFLIMG01"
+#define IMAGE_BUFFER_NODES 1024
+
+// Images are linked as if mapped at this address, so that in the common case the mapping is used as is.
+#define IMAGE_PREFERRED_BASE (sizeof(void *) == 8 ? (uint64_t)0x5a0000000000ULL : (uint64_t)0)
+
+typedef struct ImageHeader
+{
+    char magic[8];
+    uint64_t size;
+    uint64_t base;
+    uint64_t node_size;
+} ImageHeader;
+
+// Static Functions
+
+static int valid_header(const ImageHeader *header, off_t file_size)
+{
+    if (memcmp(header->magic, IMAGE_MAGIC, sizeof(header->magic)) != 0)
+        return 0;
+    if (header->node_size != sizeof(Node) || file_size < (off_t)sizeof(ImageHeader))
+        return 0;
+
+    uint64_t payload = (uint64_t)file_size - sizeof(ImageHeader);
+
+    return payload % sizeof(Node) == 0 && payload / sizeof(Node) == header->size;
+}
+
+static void relocate(void *mapping, const ImageHeader *header)
+{
+    Node *nodes = (Node *)((char *)mapping + sizeof(ImageHeader));
+    uintptr_t from = (uintptr_t)header->base;
+    uintptr_t to = (uintptr_t)mapping;
+
+    for (uint64_t i = 0; i < header->size; ++i)
+        if (nodes[i].pNext)
+            nodes[i].pNext = (Node *)((uintptr_t)nodes[i].pNext - from + to);
+}
+
+int list_image_save(List *this, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return -1;
+
+    ImageHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, IMAGE_MAGIC, sizeof(header.magic));
+    header.size = distance(cbegin(this), cend(this));
+    header.base = IMAGE_PREFERRED_BASE;
+    header.node_size = sizeof(Node);
+
+    int failed = fwrite(&header, sizeof(header), 1, file) != 1;
+
+    Node buffer[IMAGE_BUFFER_NODES];
+    memset(buffer, 0, sizeof(buffer));
+
+    uintptr_t first = (uintptr_t)header.base + sizeof(ImageHeader);
+    size_t index = 0;
+    size_t buffered = 0;
+    for (Node *p = this->head; p != NULL && !failed; p = p->pNext)
+    {
+        ++index;
+        buffer[buffered].value = p->value;
+        buffer[buffered].pNext = p->pNext ? (Node *)(first + index * sizeof(Node)) : NULL;
+
+        if (++buffered == IMAGE_BUFFER_NODES)
+        {
+            failed = fwrite(buffer, sizeof(Node), buffered, file) != buffered;
+            buffered = 0;
+        }
+    }
+
+    if (!failed && buffered)
+        failed = fwrite(buffer, sizeof(Node), buffered, file) != buffered;
+
+    if (fclose(file) != 0)
+        failed = 1;
+
+    return failed ? -1 : 0;
+}
+
+ListImage *list_image_open(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    ImageHeader header;
+    if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        !valid_header(&header, st.st_size))
+    {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    size_t length = (size_t)st.st_size;
+    void *preferred = (void *)(uintptr_t)header.base;
+    void *mapping = MAP_FAILED;
+
+    if (header.base)
+    {
+        mapping = mmap(preferred, length, PROT_READ, IMAGE_MAP_FLAGS, fd, 0);
+        if (mapping != MAP_FAILED && mapping != preferred)
+        {
+            munmap(mapping, length);
+            mapping = MAP_FAILED;
+        }
+    }
+
+    if (mapping == MAP_FAILED)
+    {
+        mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            int error = errno;
+            close(fd);
+            errno = error;
+            return NULL;
+        }
+        relocate(mapping, &header);
+        mprotect(mapping, length, PROT_READ);
+    }
+
+    close(fd);
+
+    ListImage *image = (ListImage *)malloc(sizeof(struct ListImage));
+    if (!image)
+    {
+        fprintf(stderr, "Allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    image->mapping = mapping;
+    image->length = length;
+    image->size = (size_t)header.size;
+    image->head = header.size ? (const Node *)((char *)mapping + sizeof(ImageHeader)) : NULL;
+
+    return image;
+}
+
+void list_image_close(ListImage *image)
+{
+    munmap(image->mapping, image->length);
+    free(image);
+}
+
+const_iterator list_image_cbegin(const ListImage *image)
+{
+    const_iterator iter;
+    iter.current = image->head;
+
+    return iter;
+}
+
+const_iterator list_image_cend(const ListImage *image)
+{
+    const_iterator iter;
+    iter.current = NULL;
+
+    return iter;
+}
+
+size_t list_image_size(const ListImage *image)
+{
+    return image->size;
+}
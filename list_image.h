@@ -0,0 +1,38 @@
+// Persistent, memory-mapped list images.
+
+#ifndef LIST_IMAGE_H
+#define LIST_IMAGE_H
+
+#include "forward_list.h"
+#include <stddef.h>
+
+typedef struct ListImage
+{
+    void *mapping;
+    size_t length;
+    size_t size;
+    const Node *head;
+} ListImage;
+
+// Writes the elements of "this" to the file "path" as a list image.
+// The nodes are stored contiguously in list order, linked relative to a preferred base address.
+// Returns 0 on success, -1 on failure (errno is set).
+int list_image_save(List *this, const char *path);
+
+// Maps the list image stored at "path" read-only. Nodes are paged in lazily on first access.
+// If the preferred base address is available no node is touched on open; otherwise the links are
+// relocated once in a private copy-on-write mapping.
+// Returns NULL on failure (errno is set).
+ListImage *list_image_open(const char *path);
+
+// Unmaps the image. All iterators into the image are invalidated.
+void list_image_close(ListImage *image);
+
+// Returns iterators over the mapped nodes. They can be used with every const_iterator algorithm.
+const_iterator list_image_cbegin(const ListImage *image);
+const_iterator list_image_cend(const ListImage *image);
+
+// Returns the number of elements stored in the image.
+size_t list_image_size(const ListImage *image);
+
+#endif // LIST_IMAGE_H
@@ -0,0 +1,514 @@
+#define _DEFAULT_SOURCE
+
+#include "node_pool.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#define NODE_POOL_CHUNK_NODES 4096
+#define NODE_POOL_PENDING_RANGES 64
+#define NODE_POOL_MAGAZINE_NODES 256
+#define NODE_POOL_HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+
+// Memory policy modes of mbind(2), spelled out so that libnuma headers are not needed.
+#define NODE_POOL_MPOL_PREFERRED 1
+#define NODE_POOL_MPOL_BIND 2
+#define NODE_POOL_MPOL_INTERLEAVE 3
+
+typedef enum ChunkKind
+{
+    CHUNK_REGULAR,
+    CHUNK_HUGETLB,
+    CHUNK_TRANSPARENT_HUGE
+} ChunkKind;
+
+typedef struct PoolChunk
+{
+    struct PoolChunk *next;
+    size_t count;
+    Node nodes[];
+} PoolChunk;
+
+// A released range that has not been walked yet: "first" up to, but not including, "end".
+typedef struct PendingRange
+{
+    Node *first;
+    const Node *end;
+} PendingRange;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static PoolChunk *chunks;
+static Node *free_nodes;
+static PendingRange pending[NODE_POOL_PENDING_RANGES];
+static size_t pending_count;
+static Node *bump;
+static Node *bump_end;
+static int use_huge_pages;
+static NodePoolChunkStats chunk_stats;
+static NumaPolicy numa_policy = NODE_POOL_NUMA_LOCAL;
+static int numa_policy_node;
+
+// Chunks bound to one NUMA node, carved by node_pool_alloc_chain_on() only.
+typedef struct NumaRegion
+{
+    Node *bump;
+    Node *bump_end;
+} NumaRegion;
+
+static NumaRegion numa_regions[NODE_POOL_MAX_NUMA_NODES];
+
+// Per-thread cache in front of the shared depot above. It is refilled and flushed half a magazine at a time.
+typedef struct Magazine
+{
+    Node *nodes;
+    size_t count;
+} Magazine;
+
+static pthread_once_t magazine_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t magazine_key;
+static _Thread_local Magazine magazine;
+static _Thread_local int magazine_registered;
+static _Thread_local NodePoolStats thread_stats;
+
+// Static Functions
+
+// Maps "bytes", a multiple of the huge page size, backed by huge pages and stores how in "kind".
+// Tries reserved hugetlbfs pages first, then transparent huge pages. Returns NULL if neither is available.
+static PoolChunk *map_huge_chunk(size_t bytes, ChunkKind *kind)
+{
+#ifdef MAP_HUGETLB
+    void *memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED)
+    {
+        *kind = CHUNK_HUGETLB;
+        return (PoolChunk *)memory;
+    }
+#endif
+
+#ifdef MADV_HUGEPAGE
+    // Transparent huge pages need 2MB aligned memory, so map one extra page and trim both ends.
+    size_t padded = bytes + NODE_POOL_HUGE_PAGE_SIZE;
+    char *raw = (char *)mmap(NULL, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw != (char *)MAP_FAILED)
+    {
+        uintptr_t address = ((uintptr_t)raw + NODE_POOL_HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(NODE_POOL_HUGE_PAGE_SIZE - 1);
+        char *aligned = (char *)address;
+        if (aligned != raw)
+            munmap(raw, (size_t)(aligned - raw));
+        if (raw + padded != aligned + bytes)
+            munmap(aligned + bytes, (size_t)(raw + padded - (aligned + bytes)));
+
+        *kind = madvise(aligned, bytes, MADV_HUGEPAGE) == 0 ? CHUNK_TRANSPARENT_HUGE : CHUNK_REGULAR;
+        return (PoolChunk *)aligned;
+    }
+#endif
+
+    return NULL;
+}
+
+// Maps "bytes", a multiple of the page size, of regular memory. Unlike malloc, the memory is page aligned
+// and untouched, so a NUMA policy can still decide where it goes. Returns NULL on failure.
+static PoolChunk *map_chunk(size_t bytes)
+{
+    void *memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    return memory != MAP_FAILED ? (PoolChunk *)memory : NULL;
+}
+
+static size_t round_up(size_t bytes, size_t granularity)
+{
+    return (bytes + granularity - 1) / granularity * granularity;
+}
+
+// Applies "policy" to the pages of a mapping that has not been touched yet. Returns 0 on success, -1 otherwise.
+// NODE_POOL_NUMA_NODE prefers "numa_node" and falls back to other nodes, unless "strict" forbids that.
+static int bind_memory(void *memory, size_t bytes, NumaPolicy policy, int numa_node, int strict)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    unsigned long mask = policy == NODE_POOL_NUMA_INTERLEAVE ? ~0UL : 1UL << numa_node;
+    int mode = policy == NODE_POOL_NUMA_INTERLEAVE ? NODE_POOL_MPOL_INTERLEAVE
+               : strict                            ? NODE_POOL_MPOL_BIND
+                                                   : NODE_POOL_MPOL_PREFERRED;
+
+    // The kernel drops nodes that do not exist from the interleave mask, and reads maxnode - 1 bits.
+    return syscall(SYS_mbind, memory, bytes, mode, &mask, sizeof(mask) * 8 + 1, 0) == 0 ? 0 : -1;
+#else
+    (void)memory;
+    (void)bytes;
+    (void)policy;
+    (void)numa_node;
+    (void)strict;
+    return -1;
+#endif
+}
+
+// Must be called with the lock held. Puts the unused nodes from "*begin" to "end" on the freelist, since they
+// would be unreachable once the region moves on to a new chunk.
+static void retire_region(Node **begin, Node *end)
+{
+    while (*begin != end)
+    {
+        (*begin)->pNext = free_nodes;
+        free_nodes = (*begin)++;
+    }
+}
+
+// Must be called with the lock held. Records a new chunk of "nodes" nodes taking "bytes" bytes.
+static void add_chunk(PoolChunk *chunk, size_t nodes, size_t bytes, ChunkKind kind)
+{
+    ++chunk_stats.chunks;
+    chunk_stats.bytes += bytes;
+    if (kind == CHUNK_HUGETLB)
+        ++chunk_stats.hugetlb_chunks;
+    else if (kind == CHUNK_TRANSPARENT_HUGE)
+        ++chunk_stats.transparent_huge_chunks;
+
+    chunk->next = chunks;
+    chunk->count = nodes;
+    chunks = chunk;
+}
+
+// Must be called with the lock held. Maps a chunk for at least "count" nodes, huge if enabled, page aligned
+// otherwise, and stores its node count, size and kind. Returns NULL on failure.
+static PoolChunk *map_pool_chunk(size_t count, size_t *nodes, size_t *bytes, ChunkKind *kind)
+{
+    PoolChunk *chunk = NULL;
+    size_t needed = sizeof(PoolChunk) + (count > NODE_POOL_CHUNK_NODES ? count : NODE_POOL_CHUNK_NODES) * sizeof(Node);
+
+    if (use_huge_pages)
+    {
+        *bytes = round_up(needed, NODE_POOL_HUGE_PAGE_SIZE);
+        chunk = map_huge_chunk(*bytes, kind);
+    }
+
+    if (!chunk)
+    {
+        *bytes = round_up(needed, (size_t)sysconf(_SC_PAGESIZE));
+        *kind = CHUNK_REGULAR;
+        chunk = map_chunk(*bytes);
+    }
+
+    if (chunk)
+        *nodes = (*bytes - sizeof(PoolChunk)) / sizeof(Node);
+    return chunk;
+}
+
+// Must be called with the lock held. Makes at least "count" unused nodes available at "bump".
+static void grow(size_t count)
+{
+    retire_region(&bump, bump_end);
+
+    size_t nodes;
+    size_t bytes;
+    ChunkKind kind = CHUNK_REGULAR;
+    PoolChunk *chunk = NULL;
+
+    // Huge pages and NUMA placement both need memory straight from mmap.
+    if (use_huge_pages || numa_policy != NODE_POOL_NUMA_LOCAL)
+    {
+        chunk = map_pool_chunk(count, &nodes, &bytes, &kind);
+        if (chunk && numa_policy != NODE_POOL_NUMA_LOCAL)
+            bind_memory(chunk, bytes, numa_policy, numa_policy_node, 0); // best effort, checked when the policy was set
+    }
+
+    if (!chunk)
+    {
+        nodes = count > NODE_POOL_CHUNK_NODES ? count : NODE_POOL_CHUNK_NODES;
+        bytes = sizeof(PoolChunk) + nodes * sizeof(Node);
+        chunk = (PoolChunk *)malloc(bytes);
+        if (!chunk)
+        {
+            fprintf(stderr, "Allocation failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    add_chunk(chunk, nodes, bytes, kind);
+
+    bump = chunk->nodes;
+    bump_end = chunk->nodes + nodes;
+}
+
+// Must be called with the lock held. Like grow(), but for the region of "numa_node", and the placement is
+// mandatory: returns -1, leaving the region as it is, if the chunk cannot be bound to that node.
+static int grow_on(int numa_node, size_t count)
+{
+    size_t nodes;
+    size_t bytes;
+    ChunkKind kind;
+    PoolChunk *chunk = map_pool_chunk(count, &nodes, &bytes, &kind);
+
+    if (!chunk)
+        return -1;
+    if (bind_memory(chunk, bytes, NODE_POOL_NUMA_NODE, numa_node, 1) != 0)
+    {
+        munmap(chunk, bytes);
+        return -1;
+    }
+
+    NumaRegion *region = &numa_regions[numa_node];
+    retire_region(&region->bump, region->bump_end);
+    add_chunk(chunk, nodes, bytes, kind);
+
+    region->bump = chunk->nodes;
+    region->bump_end = chunk->nodes + nodes;
+    return 0;
+}
+
+// Must be called with the lock held and pending_count > 0.
+static Node *take_pending(void)
+{
+    PendingRange *range = &pending[pending_count - 1];
+    Node *node = range->first;
+
+    range->first = node->pNext;
+    if (range->first == range->end)
+        --pending_count;
+
+    return node;
+}
+
+static void link_fresh(Node *fresh, size_t count)
+{
+    for (size_t i = 0; i + 1 < count; ++i)
+        fresh[i].pNext = &fresh[i + 1];
+    fresh[count - 1].pNext = NULL;
+}
+
+Node *node_pool_alloc_chain(size_t count, Node **tail)
+{
+    Node *first = NULL;
+    Node *last = NULL;
+    Node *fresh = NULL;
+
+    pthread_mutex_lock(&pool_lock);
+
+    // Reuse released nodes first, they are already linked.
+    if (free_nodes)
+    {
+        first = last = free_nodes;
+        --count;
+        while (count && last->pNext)
+        {
+            last = last->pNext;
+            --count;
+        }
+        free_nodes = last->pNext;
+    }
+
+    // Then walk pending ranges as far as needed; the nodes are already linked.
+    while (count && pending_count)
+    {
+        Node *node = take_pending();
+        if (last)
+            last->pNext = node;
+        else
+            first = node;
+        last = node;
+        --count;
+    }
+
+    if (last)
+        last->pNext = NULL;
+
+    // Reserve the rest as one contiguous range and link it outside the lock.
+    if (count)
+    {
+        if ((size_t)(bump_end - bump) < count)
+            grow(count);
+        fresh = bump;
+        bump += count;
+    }
+
+    pthread_mutex_unlock(&pool_lock);
+
+    if (fresh)
+    {
+        link_fresh(fresh, count);
+
+        if (last)
+            last->pNext = fresh;
+        else
+            first = fresh;
+        last = &fresh[count - 1];
+    }
+
+    *tail = last;
+    return first;
+}
+
+// Hands the first "count" nodes of the magazine back to the depot.
+static void flush_magazine(size_t count)
+{
+    Node *first = magazine.nodes;
+    Node *last = first;
+    for (size_t i = 1; i < count; ++i)
+        last = last->pNext;
+
+    magazine.nodes = last->pNext;
+    magazine.count -= count;
+    ++thread_stats.flushes;
+
+    node_pool_free_chain(first, last);
+}
+
+static void release_magazine(void *arg)
+{
+    (void)arg;
+    if (magazine.count)
+        flush_magazine(magazine.count);
+}
+
+static void create_magazine_key(void)
+{
+    pthread_key_create(&magazine_key, release_magazine);
+}
+
+// Makes sure the magazine of the calling thread goes back to the depot when the thread exits.
+static void register_magazine(void)
+{
+    pthread_once(&magazine_key_once, create_magazine_key);
+    pthread_setspecific(magazine_key, &magazine);
+    magazine_registered = 1;
+}
+
+Node *node_pool_alloc(void)
+{
+    if (!magazine.count)
+    {
+        if (!magazine_registered)
+            register_magazine();
+
+        Node *tail;
+        magazine.nodes = node_pool_alloc_chain(NODE_POOL_MAGAZINE_NODES / 2, &tail);
+        magazine.count = NODE_POOL_MAGAZINE_NODES / 2;
+        ++thread_stats.misses;
+    }
+    else
+        ++thread_stats.hits;
+
+    Node *node = magazine.nodes;
+    magazine.nodes = node->pNext;
+    --magazine.count;
+
+    return node;
+}
+
+void node_pool_free(Node *node)
+{
+    if (!magazine_registered)
+        register_magazine();
+
+    node->pNext = magazine.nodes;
+    magazine.nodes = node;
+
+    if (++magazine.count == NODE_POOL_MAGAZINE_NODES)
+        flush_magazine(NODE_POOL_MAGAZINE_NODES / 2);
+}
+
+void node_pool_free_chain(Node *first, Node *last)
+{
+    pthread_mutex_lock(&pool_lock);
+    last->pNext = free_nodes;
+    free_nodes = first;
+    pthread_mutex_unlock(&pool_lock);
+}
+
+void node_pool_use_huge_pages(int enable)
+{
+    pthread_mutex_lock(&pool_lock);
+    use_huge_pages = enable;
+    pthread_mutex_unlock(&pool_lock);
+}
+
+int node_pool_set_numa_policy(NumaPolicy policy, int numa_node)
+{
+    if (policy == NODE_POOL_NUMA_NODE && (numa_node < 0 || numa_node >= NODE_POOL_MAX_NUMA_NODES))
+        return -1;
+
+    // Try the policy on a scratch page first, so that chunks never silently ignore it.
+    if (policy != NODE_POOL_NUMA_LOCAL)
+    {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        void *probe = map_chunk(page);
+        if (!probe)
+            return -1;
+        int result = bind_memory(probe, page, policy, numa_node, 0);
+        munmap(probe, page);
+        if (result != 0)
+            return -1;
+    }
+
+    pthread_mutex_lock(&pool_lock);
+    numa_policy = policy;
+    numa_policy_node = numa_node;
+    pthread_mutex_unlock(&pool_lock);
+
+    return 0;
+}
+
+Node *node_pool_alloc_chain_on(int numa_node, size_t count, Node **tail)
+{
+    if (numa_node < 0 || numa_node >= NODE_POOL_MAX_NUMA_NODES)
+        return NULL;
+
+    pthread_mutex_lock(&pool_lock);
+    NumaRegion *region = &numa_regions[numa_node];
+    if ((size_t)(region->bump_end - region->bump) < count && grow_on(numa_node, count) != 0)
+    {
+        pthread_mutex_unlock(&pool_lock);
+        return NULL;
+    }
+    Node *fresh = region->bump;
+    region->bump += count;
+    pthread_mutex_unlock(&pool_lock);
+
+    link_fresh(fresh, count);
+    *tail = &fresh[count - 1];
+    return fresh;
+}
+
+NodePoolChunkStats node_pool_chunk_stats(void)
+{
+    pthread_mutex_lock(&pool_lock);
+    NodePoolChunkStats snapshot = chunk_stats;
+    pthread_mutex_unlock(&pool_lock);
+
+    return snapshot;
+}
+
+NodePoolStats node_pool_thread_stats(void)
+{
+    return thread_stats;
+}
+
+void node_pool_free_range(Node *first, const Node *end)
+{
+    if (first == end)
+        return;
+
+    pthread_mutex_lock(&pool_lock);
+    if (pending_count < NODE_POOL_PENDING_RANGES)
+    {
+        pending[pending_count].first = first;
+        pending[pending_count].end = end;
+        ++pending_count;
+    }
+    else
+    {
+        Node *last = first;
+        while (last->pNext != end)
+            last = last->pNext;
+
+        last->pNext = free_nodes;
+        free_nodes = first;
+    }
+    pthread_mutex_unlock(&pool_lock);
+}
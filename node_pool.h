@@ -0,0 +1,82 @@
+// Node allocator shared by every list.
+
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include "forward_list.h"
+#include <stddef.h>
+
+// Nodes are carved out of large chunks. Released nodes are kept on a freelist for reuse and the chunks
+// are only returned to the system when the process exits. All functions are thread-safe.
+//
+// Single nodes go through a small per-thread magazine, so most alloc/free pairs touch no shared state.
+// Magazines are refilled from and flushed to the shared depot in batches, and chain operations use the
+// depot directly.
+
+#define NODE_POOL_MAX_NUMA_NODES 64
+
+typedef enum NumaPolicy
+{
+    NODE_POOL_NUMA_LOCAL,     // the kernel default, pages come from the node of the thread that first touches them
+    NODE_POOL_NUMA_NODE,      // pages come from a given node while it has free memory
+    NODE_POOL_NUMA_INTERLEAVE // pages are spread round-robin over all nodes
+} NumaPolicy;
+
+typedef struct NodePoolStats
+{
+    size_t hits;    // node_pool_alloc calls served by the magazine
+    size_t misses;  // node_pool_alloc calls that had to refill the magazine
+    size_t flushes; // times a full magazine was flushed to the depot
+} NodePoolStats;
+
+typedef struct NodePoolChunkStats
+{
+    size_t chunks;
+    size_t bytes;
+    size_t hugetlb_chunks;          // chunks backed by reserved huge pages
+    size_t transparent_huge_chunks; // chunks advised to use transparent huge pages
+} NodePoolChunkStats;
+
+// Returns a single node. Its value and link are uninitialized.
+Node *node_pool_alloc(void);
+
+// Returns "count" nodes linked in order, the last one pointing to NULL, and stores the last node in "tail".
+// Values are uninitialized. Fresh nodes are contiguous, so the chain is linked in one streaming pass.
+// "count" must be greater than 0.
+Node *node_pool_alloc_chain(size_t count, Node **tail);
+
+// Releases a single node.
+void node_pool_free(Node *node);
+
+// Releases the chain of nodes from "first" to "last", both included, in O(1).
+void node_pool_free_chain(Node *first, Node *last);
+
+// Releases the nodes from "first" up to, but not including, "end" without walking them.
+// The range is recorded as is and only walked when its nodes are handed out again.
+// "end" may be NULL to release a whole NULL-terminated chain.
+void node_pool_free_range(Node *first, const Node *end);
+
+// Returns the magazine counters of the calling thread.
+NodePoolStats node_pool_thread_stats(void);
+
+// Backs chunks created from now on with 2MB huge pages, which cuts TLB misses when traversing long lists.
+// Reserved hugetlbfs pages are used if available, transparent huge pages otherwise, and regular memory
+// if neither can be had. Chunks are rounded up to whole huge pages. Existing chunks are not affected.
+void node_pool_use_huge_pages(int enable);
+
+// Places chunks created from now on according to "policy". "numa_node" is only used by NODE_POOL_NUMA_NODE.
+// Released nodes are recycled regardless of where they live, so this is best used before building long lists.
+// Returns 0 on success, -1 if "numa_node" is out of range or the kernel rejects the policy.
+int node_pool_set_numa_policy(NumaPolicy policy, int numa_node);
+
+// Returns "count" fresh, contiguous nodes on NUMA node "numa_node", linked in order, the last one pointing to
+// NULL, and stores the last node in "tail". Values are uninitialized. The chunks are bound to "numa_node" with
+// no fallback to other nodes, and are carved for this function only; the nodes left at the end of a chunk
+// when it is replaced by a new one, like the nodes released later, go to the shared pool.
+// Returns NULL if the nodes cannot be placed on "numa_node". "count" must be greater than 0.
+Node *node_pool_alloc_chain_on(int numa_node, size_t count, Node **tail);
+
+// Returns the number and kind of chunks allocated so far.
+NodePoolChunkStats node_pool_chunk_stats(void);
+
+#endif // NODE_POOL_H
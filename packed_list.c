@@ -0,0 +1,271 @@
+#include "packed_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Static Functions
+
+static void *checked_realloc(void *ptr, size_t size)
+{
+    void *result = realloc(ptr, size);
+    if (!result)
+    {
+        fprintf(stderr, "Allocation failed");
+        exit(EXIT_FAILURE);
+    }
+
+    return result;
+}
+
+static PackedList *create_packed(int sorted)
+{
+    PackedList *this = (PackedList *)malloc(sizeof(struct PackedList));
+    if (!this)
+    {
+        fprintf(stderr, "Allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    this->size = 0;
+    this->sorted = sorted;
+    this->blocks = NULL;
+    this->block_count = 0;
+    this->block_capacity = 0;
+    this->data = NULL;
+    this->data_size = 0;
+    this->data_capacity = 0;
+
+    return this;
+}
+
+static void put_varint(PackedList *this, uint32_t delta)
+{
+    if (this->data_capacity - this->data_size < 5)
+    {
+        this->data_capacity = this->data_capacity ? this->data_capacity * 2 : 64;
+        this->data = (unsigned char *)checked_realloc(this->data, this->data_capacity);
+    }
+
+    unsigned char *out = this->data + this->data_size;
+    while (delta >= 0x80)
+    {
+        *out++ = (unsigned char)(delta | 0x80);
+        delta >>= 7;
+    }
+    *out++ = (unsigned char)delta;
+
+    this->data_size = (size_t)(out - this->data);
+}
+
+static uint32_t get_varint(const unsigned char **cursor)
+{
+    const unsigned char *in = *cursor;
+    uint32_t delta = *in & 0x7f;
+    unsigned shift = 7;
+
+    while (*in++ & 0x80)
+    {
+        delta |= (uint32_t)(*in & 0x7f) << shift;
+        shift += 7;
+    }
+
+    *cursor = in;
+    return delta;
+}
+
+// Deltas are computed modulo 2^32, so they never overflow even for extreme values.
+static void append(PackedList *this, int value, int *prev)
+{
+    PackedBlock *block = this->block_count ? &this->blocks[this->block_count - 1] : NULL;
+
+    if (!block || block->count == PACKED_BLOCK_SIZE)
+    {
+        if (this->block_count == this->block_capacity)
+        {
+            this->block_capacity = this->block_capacity ? this->block_capacity * 2 : 16;
+            this->blocks = (PackedBlock *)checked_realloc(this->blocks, this->block_capacity * sizeof(PackedBlock));
+        }
+
+        block = &this->blocks[this->block_count++];
+        block->first = value;
+        block->count = 1;
+        block->offset = this->data_size;
+    }
+    else
+    {
+        uint32_t delta = (uint32_t)value - (uint32_t)*prev;
+        if (!this->sorted)
+            delta = (delta << 1) ^ (uint32_t)-(int32_t)(delta >> 31);
+
+        put_varint(this, delta);
+        ++block->count;
+    }
+
+    *prev = value;
+    ++this->size;
+}
+
+static int decode(const PackedList *this, const unsigned char **cursor, int prev)
+{
+    uint32_t delta = get_varint(cursor);
+    if (!this->sorted)
+        delta = (delta >> 1) ^ (uint32_t)-(int32_t)(delta & 1);
+
+    return (int)((uint32_t)prev + delta);
+}
+
+static packed_iterator block_begin(const PackedList *this, size_t block, size_t position)
+{
+    packed_iterator iter;
+    iter.list = this;
+    iter.position = position;
+    iter.block = block;
+    iter.index = 0;
+    iter.cursor = NULL;
+    iter.value = 0;
+
+    if (block < this->block_count)
+    {
+        iter.cursor = this->data + this->blocks[block].offset;
+        iter.value = this->blocks[block].first;
+    }
+
+    return iter;
+}
+
+PackedList *packed_from_list(List *this)
+{
+    PackedList *packed = create_packed(is_sorted(cbegin(this), cend(this)));
+
+    int prev = 0;
+    for (Node *p = this->head; p != NULL; p = p->pNext)
+        append(packed, p->value, &prev);
+
+    return packed;
+}
+
+List *packed_to_list(const PackedList *this)
+{
+    List *list = create_list();
+    iterator tail = begin(list);
+
+    for (packed_iterator iter = packed_cbegin(this); iter.position != this->size; packed_next(&iter))
+    {
+        if (!tail.current)
+        {
+            push_front(list, iter.value);
+            tail = begin(list);
+        }
+        else
+            tail = insert_after(tail, iter.value);
+    }
+
+    return list;
+}
+
+void packed_destroy(PackedList *this)
+{
+    free(this->blocks);
+    free(this->data);
+    free(this);
+}
+
+size_t packed_size(const PackedList *this)
+{
+    return this->size;
+}
+
+size_t packed_memory_usage(const PackedList *this)
+{
+    return sizeof(PackedList) + this->block_count * sizeof(PackedBlock) + this->data_size;
+}
+
+packed_iterator packed_cbegin(const PackedList *this)
+{
+    return block_begin(this, 0, 0);
+}
+
+packed_iterator packed_cend(const PackedList *this)
+{
+    return block_begin(this, this->block_count, this->size);
+}
+
+void packed_next(packed_iterator *iter)
+{
+    const PackedList *this = iter->list;
+
+    if (++iter->position == this->size)
+        return;
+
+    if (++iter->index == this->blocks[iter->block].count)
+        *iter = block_begin(this, iter->block + 1, iter->position);
+    else
+        iter->value = decode(this, &iter->cursor, iter->value);
+}
+
+int packed_is_sorted(const PackedList *this)
+{
+    return this->sorted;
+}
+
+packed_iterator packed_cfind(const PackedList *this, int value)
+{
+    size_t block = 0;
+
+    if (this->sorted)
+    {
+        // Finds the last block whose first value is less than "value"; equal values may end it.
+        size_t low = 0;
+        size_t high = this->block_count;
+        while (low < high)
+        {
+            size_t mid = low + (high - low) / 2;
+            if (this->blocks[mid].first < value)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        block = low ? low - 1 : 0;
+    }
+
+    packed_iterator iter = block_begin(this, block, block * PACKED_BLOCK_SIZE);
+    for (; iter.position != this->size; packed_next(&iter))
+    {
+        if (iter.value == value)
+            return iter;
+        if (this->sorted && iter.value > value)
+            break;
+    }
+
+    return packed_cend(this);
+}
+
+PackedList *packed_merge(const PackedList *first, const PackedList *second)
+{
+    if (!first->sorted || !second->sorted)
+        return NULL;
+
+    PackedList *merged = create_packed(1);
+    packed_iterator iter1 = packed_cbegin(first);
+    packed_iterator iter2 = packed_cbegin(second);
+    int prev = 0;
+
+    while (iter1.position != first->size && iter2.position != second->size)
+    {
+        if (iter2.value < iter1.value)
+        {
+            append(merged, iter2.value, &prev);
+            packed_next(&iter2);
+        }
+        else
+        {
+            append(merged, iter1.value, &prev);
+            packed_next(&iter1);
+        }
+    }
+
+    for (; iter1.position != first->size; packed_next(&iter1))
+        append(merged, iter1.value, &prev);
+    for (; iter2.position != second->size; packed_next(&iter2))
+        append(merged, iter2.value, &prev);
+
+    return merged;
+}
@@ -0,0 +1,76 @@
+// Compressed, immutable list storage.
+
+#ifndef PACKED_LIST_H
+#define PACKED_LIST_H
+
+#include "forward_list.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define PACKED_BLOCK_SIZE 128
+
+// Every block keeps its first value verbatim followed by up to PACKED_BLOCK_SIZE - 1 varint deltas.
+typedef struct PackedBlock
+{
+    int first;
+    uint32_t count;
+    size_t offset;
+} PackedBlock;
+
+typedef struct PackedList
+{
+    size_t size;
+    int sorted;
+    PackedBlock *blocks;
+    size_t block_count;
+    size_t block_capacity;
+    unsigned char *data;
+    size_t data_size;
+    size_t data_capacity;
+} PackedList;
+
+typedef struct packed_iterator
+{
+    const PackedList *list;
+    size_t position;
+    size_t block;
+    uint32_t index;
+    const unsigned char *cursor;
+    int value;
+} packed_iterator;
+
+// Creates a compressed copy of "this". Sorted lists store plain deltas, any other list stores
+// zigzag-encoded deltas so that the conversion works for every list.
+PackedList *packed_from_list(List *this);
+
+// Creates a regular list holding the same elements in the same order.
+List *packed_to_list(const PackedList *this);
+
+void packed_destroy(PackedList *this);
+
+// Returns the number of elements.
+size_t packed_size(const PackedList *this);
+
+// Returns the number of bytes used by the compressed representation.
+size_t packed_memory_usage(const PackedList *this);
+
+// Returns iterators to the first element and past the last element.
+// The current element of "iter" is iter.value and is only valid while iter.position < packed_size().
+packed_iterator packed_cbegin(const PackedList *this);
+packed_iterator packed_cend(const PackedList *this);
+
+// Decodes the next element.
+void packed_next(packed_iterator *iter);
+
+// Checks if the elements are sorted in non-descending order.
+int packed_is_sorted(const PackedList *this);
+
+// Returns an iterator to the first element equal to "value", or packed_cend() if there is none.
+// Sorted lists binary search the block index and decode a single block.
+packed_iterator packed_cfind(const PackedList *this, int value);
+
+// Merges two sorted packed lists into a new one, decoding and encoding blocks on the fly.
+// Returns NULL if either list is not sorted.
+PackedList *packed_merge(const PackedList *first, const PackedList *second);
+
+#endif // PACKED_LIST_H
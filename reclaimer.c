@@ -0,0 +1,220 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "reclaimer.h"
+#include "node_pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct PendingChain
+{
+    Node *first;
+    const Node *end;
+    void (*free_fn)(void *ptr, void *ctx);
+    void *ctx;
+    struct PendingChain *next;
+} PendingChain;
+
+static pthread_mutex_t reclaimer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reclaimer_wakeup = PTHREAD_COND_INITIALIZER;
+static pthread_t reclaimer_thread;
+static atomic_int running;
+static int stopping;
+static PendingChain *queue_head;
+static PendingChain *queue_tail;
+static size_t batch_nodes;
+static unsigned batch_pause_us;
+static ReclaimerStats stats;
+
+// Static Functions
+
+static void pause_between_batches(void)
+{
+    if (!batch_pause_us)
+        return;
+
+    struct timespec delay;
+    delay.tv_sec = batch_pause_us / 1000000;
+    delay.tv_nsec = (long)(batch_pause_us % 1000000) * 1000;
+    nanosleep(&delay, NULL);
+}
+
+static void release(Node *first, const Node *end, void (*free_fn)(void *ptr, void *ctx), void *ctx)
+{
+    while (first != end)
+    {
+        Node *next = first->pNext;
+        free_fn(first, ctx);
+        first = next;
+    }
+}
+
+static void release_now(Node *first, const Node *end, void (*free_fn)(void *ptr, void *ctx), void *ctx)
+{
+    if (free_fn)
+        release(first, end, free_fn, ctx);
+    else
+        node_pool_free_range(first, end);
+}
+
+// Returns the chain to its allocator one batch at a time. Runs without the lock held.
+static void reclaim(PendingChain *chain)
+{
+    Node *first = chain->first;
+
+    while (first != chain->end)
+    {
+        Node *last = first;
+        size_t count = 1;
+        while (count < batch_nodes && last->pNext != chain->end)
+        {
+            last = last->pNext;
+            ++count;
+        }
+
+        Node *next = last->pNext;
+        if (chain->free_fn)
+            release(first, next, chain->free_fn, chain->ctx);
+        else
+            node_pool_free_chain(first, last);
+        first = next;
+
+        pthread_mutex_lock(&reclaimer_lock);
+        stats.reclaimed_nodes += count;
+        ++stats.batches;
+        pthread_mutex_unlock(&reclaimer_lock);
+
+        if (first != chain->end)
+            pause_between_batches();
+    }
+}
+
+static void *reclaimer_main(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&reclaimer_lock);
+    for (;;)
+    {
+        while (!queue_head && !stopping)
+            pthread_cond_wait(&reclaimer_wakeup, &reclaimer_lock);
+
+        if (!queue_head)
+            break;
+
+        PendingChain *chain = queue_head;
+        queue_head = chain->next;
+        if (!queue_head)
+            queue_tail = NULL;
+        pthread_mutex_unlock(&reclaimer_lock);
+
+        reclaim(chain);
+        free(chain);
+
+        pthread_mutex_lock(&reclaimer_lock);
+        --stats.pending_ranges;
+    }
+    pthread_mutex_unlock(&reclaimer_lock);
+
+    return NULL;
+}
+
+void reclaimer_start(size_t batch_size, unsigned pause_us)
+{
+    pthread_mutex_lock(&reclaimer_lock);
+    if (atomic_load(&running))
+    {
+        pthread_mutex_unlock(&reclaimer_lock);
+        return;
+    }
+
+    batch_nodes = batch_size ? batch_size : 1;
+    batch_pause_us = pause_us;
+    stopping = 0;
+
+    if (pthread_create(&reclaimer_thread, NULL, reclaimer_main, NULL) != 0)
+    {
+        fprintf(stderr, "Could not start the reclaimer thread");
+        exit(EXIT_FAILURE);
+    }
+    atomic_store(&running, 1);
+    pthread_mutex_unlock(&reclaimer_lock);
+}
+
+void reclaimer_stop(void)
+{
+    pthread_mutex_lock(&reclaimer_lock);
+    if (!atomic_load(&running))
+    {
+        pthread_mutex_unlock(&reclaimer_lock);
+        return;
+    }
+
+    atomic_store(&running, 0);
+    stopping = 1;
+    pthread_cond_signal(&reclaimer_wakeup);
+    pthread_mutex_unlock(&reclaimer_lock);
+
+    pthread_join(reclaimer_thread, NULL);
+}
+
+int reclaimer_running(void)
+{
+    return atomic_load_explicit(&running, memory_order_relaxed);
+}
+
+void reclaimer_submit(Node *first, const Node *end, void (*free_fn)(void *ptr, void *ctx), void *ctx)
+{
+    if (first == end)
+        return;
+
+    if (!reclaimer_running())
+    {
+        release_now(first, end, free_fn, ctx);
+        return;
+    }
+
+    PendingChain *chain = (PendingChain *)malloc(sizeof(PendingChain));
+    if (!chain)
+    {
+        fprintf(stderr, "Allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    chain->first = first;
+    chain->end = end;
+    chain->free_fn = free_fn;
+    chain->ctx = ctx;
+    chain->next = NULL;
+
+    pthread_mutex_lock(&reclaimer_lock);
+    if (!atomic_load(&running))
+    {
+        // Lost a race with reclaimer_stop().
+        pthread_mutex_unlock(&reclaimer_lock);
+        free(chain);
+        release_now(first, end, free_fn, ctx);
+        return;
+    }
+
+    if (queue_tail)
+        queue_tail->next = chain;
+    else
+        queue_head = chain;
+    queue_tail = chain;
+
+    ++stats.pending_ranges;
+    ++stats.submitted_ranges;
+    pthread_cond_signal(&reclaimer_wakeup);
+    pthread_mutex_unlock(&reclaimer_lock);
+}
+
+ReclaimerStats reclaimer_stats(void)
+{
+    pthread_mutex_lock(&reclaimer_lock);
+    ReclaimerStats snapshot = stats;
+    pthread_mutex_unlock(&reclaimer_lock);
+
+    return snapshot;
+}
@@ -0,0 +1,39 @@
+// Background reclamation of released node chains.
+
+#ifndef RECLAIMER_H
+#define RECLAIMER_H
+
+#include "forward_list.h"
+#include <stddef.h>
+
+typedef struct ReclaimerStats
+{
+    size_t pending_ranges;  // ranges submitted but not fully reclaimed yet
+    size_t submitted_ranges;
+    size_t reclaimed_nodes;
+    size_t batches;
+} ReclaimerStats;
+
+// Starts the background reclaimer. While it runs, clear(), destroy_list() and erase_after_range()
+// detach their nodes in O(1) and the reclaimer returns them to the node pool "batch_size" nodes at a time,
+// sleeping "pause_us" microseconds between batches to bound its CPU use.
+// Does nothing if the reclaimer is already running.
+void reclaimer_start(size_t batch_size, unsigned pause_us);
+
+// Reclaims everything that is still pending and stops the reclaimer thread.
+void reclaimer_stop(void);
+
+// Returns true(1) if the reclaimer is running, false(0) otherwise.
+int reclaimer_running(void);
+
+// Queues the nodes from "first" up to, but not including, "end" for reclamation.
+// "end" may be NULL for a whole NULL-terminated chain. The nodes are released with "free_fn", or to the
+// node pool if it is NULL. If the reclaimer is not running, they are released right away.
+// A non-NULL "free_fn" is called on the reclaimer thread, so it must be thread-safe and "ctx" must stay valid
+// until the nodes have been reclaimed. The list functions only submit nodes that belong to the node pool.
+void reclaimer_submit(Node *first, const Node *end, void (*free_fn)(void *ptr, void *ctx), void *ctx);
+
+// Returns a snapshot of the reclaimer counters.
+ReclaimerStats reclaimer_stats(void);
+
+#endif // RECLAIMER_H
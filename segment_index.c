@@ -0,0 +1,247 @@
+#include "segment_index.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Below this many nodes per thread, starting threads costs more than it saves.
+#define SEGMENT_INDEX_MIN_THREAD_NODES 65536
+#define SEGMENT_INDEX_MAX_THREADS 64
+
+typedef struct ReverseTask
+{
+    Segment *segments;
+    size_t count;
+} ReverseTask;
+
+// Static Functions
+
+static void push_segment(SegmentIndex *index, Segment segment)
+{
+    if (index->count == index->capacity)
+    {
+        size_t capacity = index->capacity ? 2 * index->capacity : 16;
+        Segment *segments = (Segment *)realloc(index->segments, capacity * sizeof(Segment));
+        if (!segments)
+        {
+            fprintf(stderr, "Allocation failed");
+            exit(EXIT_FAILURE);
+        }
+        index->segments = segments;
+        index->capacity = capacity;
+    }
+
+    index->segments[index->count++] = segment;
+}
+
+// Adds "node", the next node of a walk, to the last segment or starts a new one. "direction" keeps
+// track of whether the nodes seen so far are contiguous.
+static void record(SegmentIndex *index, Node *node)
+{
+    Segment *last = index->count ? &index->segments[index->count - 1] : NULL;
+    if (!last || last->length == index->segment_nodes)
+    {
+        Segment segment = {node, node, 1, 1};
+        push_segment(index, segment);
+        return;
+    }
+
+    if (last->length == 1)
+        last->direction = node == last->last + 1 ? 1 : node == last->last - 1 ? -1 : 0;
+    else if (last->direction && node != last->last + last->direction)
+        last->direction = 0;
+
+    last->last = node;
+    ++last->length;
+}
+
+static void build(SegmentIndex *index)
+{
+    index->count = 0;
+    for (Node *p = index->list->head; p != NULL; p = p->pNext)
+        record(index, p);
+
+    index->version = index->list->version;
+}
+
+// Reverses the links inside each segment. The first node of a segment is left pointing to NULL.
+static void reverse_segments(Segment *segments, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        Segment *segment = &segments[i];
+
+        if (segment->direction)
+        {
+            // Every node links to its neighbour on the other side, in address order.
+            Node *low = segment->direction > 0 ? segment->first : segment->last;
+            Node *high = low + (segment->length - 1);
+            if (segment->direction > 0)
+            {
+                for (Node *p = low + 1; p <= high; ++p)
+                    p->pNext = p - 1;
+            }
+            else
+            {
+                for (Node *p = low; p < high; ++p)
+                    p->pNext = p + 1;
+            }
+            segment->first->pNext = NULL;
+        }
+        else
+        {
+            Node *current = segment->first;
+            Node *prev = NULL;
+            for (size_t n = segment->length; n; --n)
+            {
+                Node *next = current->pNext;
+                current->pNext = prev;
+                prev = current;
+                current = next;
+            }
+        }
+    }
+}
+
+static void *reverse_task(void *arg)
+{
+    ReverseTask *task = (ReverseTask *)arg;
+    reverse_segments(task->segments, task->count);
+
+    return NULL;
+}
+
+// Reverses the segments on up to index->threads threads, the calling thread included.
+static void reverse_in_parallel(SegmentIndex *index)
+{
+    size_t nodes = 0;
+    for (size_t i = 0; i < index->count; ++i)
+        nodes += index->segments[i].length;
+
+    size_t threads = index->threads < SEGMENT_INDEX_MAX_THREADS ? index->threads : SEGMENT_INDEX_MAX_THREADS;
+    if (threads > nodes / SEGMENT_INDEX_MIN_THREAD_NODES)
+        threads = nodes / SEGMENT_INDEX_MIN_THREAD_NODES;
+    if (threads > index->count)
+        threads = index->count;
+    if (threads < 2)
+    {
+        reverse_segments(index->segments, index->count);
+        return;
+    }
+
+    pthread_t workers[SEGMENT_INDEX_MAX_THREADS];
+    int started[SEGMENT_INDEX_MAX_THREADS];
+    ReverseTask tasks[SEGMENT_INDEX_MAX_THREADS];
+    size_t per_task = (index->count + threads - 1) / threads;
+
+    for (size_t t = 0; t < threads; ++t)
+    {
+        size_t begin = t * per_task;
+        size_t end = begin + per_task < index->count ? begin + per_task : index->count;
+        tasks[t].segments = index->segments + begin;
+        tasks[t].count = end > begin ? end - begin : 0;
+
+        // The last task runs on the calling thread, as does any task whose thread could not be started.
+        started[t] = t + 1 < threads && pthread_create(&workers[t], NULL, reverse_task, &tasks[t]) == 0;
+        if (!started[t])
+            reverse_task(&tasks[t]);
+    }
+
+    for (size_t t = 0; t < threads; ++t)
+    {
+        if (started[t])
+            pthread_join(workers[t], NULL);
+    }
+}
+
+// Reverses the list in one pass, recording its segments in the old order, then turns the index around.
+static Node *reverse_and_rebuild(SegmentIndex *index)
+{
+    Node *current = index->list->head;
+    Node *prev = NULL;
+
+    index->count = 0;
+    while (current)
+    {
+        record(index, current);
+        Node *next = current->pNext;
+        current->pNext = prev;
+        prev = current;
+        current = next;
+    }
+
+    for (size_t i = 0, j = index->count; i + 1 < j; ++i, --j)
+    {
+        Segment temp = index->segments[i];
+        index->segments[i] = index->segments[j - 1];
+        index->segments[j - 1] = temp;
+    }
+    for (size_t i = 0; i < index->count; ++i)
+    {
+        Segment *segment = &index->segments[i];
+        Node *first = segment->first;
+        segment->first = segment->last;
+        segment->last = first;
+        segment->direction = -segment->direction;
+    }
+
+    return prev;
+}
+
+SegmentIndex *segment_index_attach(List *list, size_t segment_nodes, unsigned threads)
+{
+    if (list->segment_index)
+        return list->segment_index;
+
+    SegmentIndex *index = (SegmentIndex *)malloc(sizeof(SegmentIndex));
+    if (!index)
+    {
+        fprintf(stderr, "Allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    index->list = list;
+    index->segments = NULL;
+    index->count = 0;
+    index->capacity = 0;
+    index->segment_nodes = segment_nodes ? segment_nodes : 1;
+    index->threads = threads;
+    build(index);
+
+    list->segment_index = index;
+    return index;
+}
+
+void segment_index_detach(List *list)
+{
+    SegmentIndex *index = list->segment_index;
+    if (!index)
+        return;
+
+    free(index->segments);
+    free(index);
+    list->segment_index = NULL;
+}
+
+Node *segment_index_reverse(SegmentIndex *index)
+{
+    if (index->version != index->list->version)
+        return reverse_and_rebuild(index);
+    if (!index->count)
+        return NULL;
+
+    reverse_in_parallel(index);
+
+    // Stitch the reversed segments back to front, and turn the index around to match.
+    Segment *segments = index->segments;
+    for (size_t i = index->count - 1; i > 0; --i)
+        segments[i].first->pNext = segments[i - 1].last;
+
+    for (size_t i = 0, j = index->count; i < j; ++i, --j)
+    {
+        Segment low = segments[i];
+        Segment high = segments[j - 1];
+        segments[i] = (Segment){high.last, high.first, high.length, -high.direction};
+        segments[j - 1] = (Segment){low.last, low.first, low.length, -low.direction};
+    }
+
+    return segments[0].first;
+}
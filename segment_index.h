@@ -0,0 +1,44 @@
+// Segment index for reversing long lists in parallel.
+
+#ifndef SEGMENT_INDEX_H
+#define SEGMENT_INDEX_H
+
+#include "forward_list.h"
+#include <stddef.h>
+
+// A stretch of the list. "direction" is 1 or -1 if its nodes lie next to each other in memory, each one
+// linking to the node at address p + direction, and 0 otherwise.
+typedef struct Segment
+{
+    Node *first;
+    Node *last;
+    size_t length;
+    int direction;
+} Segment;
+
+typedef struct SegmentIndex
+{
+    List *list;
+    Segment *segments; // in list order
+    size_t count;
+    size_t capacity;
+    size_t segment_nodes;
+    unsigned threads;
+    unsigned long version; // version of the list the segments describe
+} SegmentIndex;
+
+// Splits "list" into segments of "segment_nodes" nodes and attaches the result, so that reverse() reverses
+// the segments on up to "threads" threads and then stitches them together. Segments whose nodes are
+// contiguous in memory are reversed in address order, so their writes stream instead of chasing links.
+// Returns the index already attached, if any. destroy_list() detaches the index.
+SegmentIndex *segment_index_attach(List *list, size_t segment_nodes, unsigned threads);
+
+// Releases the index attached to "list", if any.
+void segment_index_detach(List *list);
+
+// Reverses the links of the list the index is attached to, and the index along with them. If the list has
+// changed since the index was built, it is reversed sequentially and the index is rebuilt in the same pass.
+// Returns the new first node. Used by reverse(), which keeps the rest of the list bookkeeping.
+Node *segment_index_reverse(SegmentIndex *index);
+
+#endif // SEGMENT_INDEX_H
@@ -0,0 +1,261 @@
+#include "skip_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Static Functions
+
+static SkipTower *createTower(Node *node, int height)
+{
+    SkipTower *tower = (SkipTower *)malloc(sizeof(SkipTower) + (size_t)height * sizeof(SkipTower *));
+    if (!tower)
+    {
+        fprintf(stderr, "Allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    tower->node = node;
+    for (int level = 0; level < height; ++level)
+        tower->next[level] = NULL;
+
+    return tower;
+}
+
+// Returns the number of levels of a new tower, 0 if the node gets no tower. Each level is kept with probability 1/4.
+static int random_height(SkipIndex *index)
+{
+    // xorshift32
+    unsigned x = index->state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    index->state = x;
+
+    int height = 0;
+    while (height < SKIP_INDEX_MAX_LEVEL && (x & 3) == 0)
+    {
+        ++height;
+        x >>= 2;
+    }
+
+    return height;
+}
+
+// Every tower has at least one level, so all of them are linked on level 0.
+static void destroy_towers(SkipIndex *index)
+{
+    SkipTower *tower = index->head->next[0];
+    while (tower)
+    {
+        SkipTower *next = tower->next[0];
+        free(tower);
+        tower = next;
+    }
+
+    for (int level = 0; level < SKIP_INDEX_MAX_LEVEL; ++level)
+        index->head->next[level] = NULL;
+    index->level = 0;
+}
+
+static void build(SkipIndex *index)
+{
+    SkipTower *last[SKIP_INDEX_MAX_LEVEL];
+    for (int level = 0; level < SKIP_INDEX_MAX_LEVEL; ++level)
+        last[level] = index->head;
+
+    for (Node *p = index->list->head; p != NULL; p = p->pNext)
+    {
+        int height = random_height(index);
+        if (!height)
+            continue;
+
+        SkipTower *tower = createTower(p, height);
+        for (int level = 0; level < height; ++level)
+        {
+            last[level]->next[level] = tower;
+            last[level] = tower;
+        }
+        if (height > index->level)
+            index->level = height;
+    }
+
+    index->version = index->list->version;
+}
+
+// Rebuilds the towers if the list has been changed behind the back of the index. Returns false(0) if the
+// list is no longer sorted; the index then stays unusable until the list changes again.
+static int refresh(SkipIndex *index)
+{
+    List *list = index->list;
+    if (index->version == list->version)
+        return index->usable;
+
+    destroy_towers(index);
+    index->usable = list->sorted || is_sorted(cbegin(list), cend(list));
+    if (index->usable)
+    {
+        list->sorted = 1;
+        build(index);
+    }
+    else
+        index->version = list->version;
+
+    return index->usable;
+}
+
+static int precedes(int element, int value, int inclusive)
+{
+    return inclusive ? element <= value : element < value;
+}
+
+// Returns the last node whose value is less than "value", or not greater than it if "inclusive".
+// The sentinel is returned if there is no such node. If "update" is not NULL, the last tower visited
+// on each level in use is stored in it.
+static Node *search(SkipIndex *index, int value, int inclusive, SkipTower **update)
+{
+    SkipTower *tower = index->head;
+    for (int level = index->level - 1; level >= 0; --level)
+    {
+        while (tower->next[level] && precedes(tower->next[level]->node->value, value, inclusive))
+            tower = tower->next[level];
+        if (update)
+            update[level] = tower;
+    }
+
+    Node *p = tower->node;
+    while (p->pNext && precedes(p->pNext->value, value, inclusive))
+        p = p->pNext;
+
+    return p;
+}
+
+SkipIndex *skip_index_attach(List *list)
+{
+    if (list->skip_index)
+        return list->skip_index;
+    if (!is_sorted(cbegin(list), cend(list)))
+        return NULL;
+
+    SkipIndex *index = (SkipIndex *)malloc(sizeof(SkipIndex));
+    if (!index)
+    {
+        fprintf(stderr, "Allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    index->list = list;
+    index->head = createTower(&list->before_head, SKIP_INDEX_MAX_LEVEL);
+    index->level = 0;
+    index->state = 2463534242u;
+    index->usable = 1;
+    list->sorted = 1;
+    build(index);
+
+    list->skip_index = index;
+    return index;
+}
+
+void skip_index_detach(List *list)
+{
+    SkipIndex *index = list->skip_index;
+    if (!index)
+        return;
+
+    destroy_towers(index);
+    free(index->head);
+    free(index);
+    list->skip_index = NULL;
+}
+
+const_iterator skip_index_lower_bound(SkipIndex *index, int value)
+{
+    const_iterator iter;
+    iter.current = refresh(index) ? search(index, value, 0, NULL)->pNext : NULL;
+
+    return iter;
+}
+
+const_iterator skip_index_upper_bound(SkipIndex *index, int value)
+{
+    const_iterator iter;
+    iter.current = refresh(index) ? search(index, value, 1, NULL)->pNext : NULL;
+
+    return iter;
+}
+
+const_iterator skip_index_find(SkipIndex *index, int value)
+{
+    const_iterator iter = skip_index_lower_bound(index, value);
+    if (iter.current && iter.current->value != value)
+        iter.current = NULL;
+
+    return iter;
+}
+
+iterator skip_index_insert(SkipIndex *index, int value)
+{
+    SkipTower *update[SKIP_INDEX_MAX_LEVEL];
+
+    iterator pos;
+    pos.owner = index->list;
+    if (!refresh(index))
+    {
+        pos.current = NULL;
+        return pos;
+    }
+
+    pos.current = search(index, value, 1, update);
+    pos = insert_after(pos, value);
+
+    int height = random_height(index);
+    if (height)
+    {
+        for (int level = index->level; level < height; ++level)
+            update[level] = index->head;
+        if (height > index->level)
+            index->level = height;
+
+        SkipTower *tower = createTower(pos.current, height);
+        for (int level = 0; level < height; ++level)
+        {
+            tower->next[level] = update[level]->next[level];
+            update[level]->next[level] = tower;
+        }
+    }
+
+    // The towers were kept up to date along with the list.
+    index->version = index->list->version;
+    return pos;
+}
+
+size_t skip_index_erase(SkipIndex *index, int value)
+{
+    SkipTower *update[SKIP_INDEX_MAX_LEVEL];
+    size_t count = 0;
+
+    if (!refresh(index))
+        return 0;
+
+    iterator pos;
+    pos.current = search(index, value, 0, update);
+    pos.owner = index->list;
+
+    while (pos.current->pNext && pos.current->pNext->value == value)
+    {
+        // The first tower after update[level] on each level is the one of the node being removed, if it has one.
+        const Node *target = pos.current->pNext;
+        SkipTower *tower = NULL;
+        for (int level = 0; level < index->level; ++level)
+        {
+            SkipTower *next = update[level]->next[level];
+            if (!next || next->node != target)
+                break;
+            update[level]->next[level] = next->next[level];
+            tower = next;
+        }
+        free(tower);
+
+        erase_after(pos);
+        ++count;
+    }
+
+    index->version = index->list->version;
+    return count;
+}
@@ -0,0 +1,58 @@
+// Skip-list index over a sorted list.
+
+#ifndef SKIP_INDEX_H
+#define SKIP_INDEX_H
+
+#include "forward_list.h"
+#include <stddef.h>
+
+#define SKIP_INDEX_MAX_LEVEL 16
+
+// Express lanes over the nodes of a sorted list. About one node in four gets a tower, and each level
+// of a tower is kept with probability 1/4, so lookups visit O(log n) towers and then a few list nodes.
+// The towers live beside the list; the list itself is unchanged and can be used as usual.
+typedef struct SkipTower
+{
+    Node *node; // the sentinel of the list for the head tower
+    struct SkipTower *next[];
+} SkipTower;
+
+typedef struct SkipIndex
+{
+    List *list;
+    SkipTower *head;
+    int level;             // levels in use
+    unsigned long version; // version of the list the towers describe
+    unsigned state;        // random number generator state
+    int usable;            // false(0) while the list is not sorted
+} SkipIndex;
+
+// Builds an index over "list" in O(n) and attaches it. Returns NULL if the list is not sorted, and the index
+// already attached, if any. Changes made to the list by other functions are detected and the index is rebuilt
+// on its next use. If they left the list unsorted, the index is unusable until the list is sorted again:
+// lookups return cend, skip_index_insert returns end and skip_index_erase removes nothing. The index never
+// reorders the list itself. destroy_list() detaches the index.
+SkipIndex *skip_index_attach(List *list);
+
+// Releases the index attached to "list", if any. The list is not affected.
+void skip_index_detach(List *list);
+
+// Returns an iterator to the first element that is not less than "value", or cend if there is none.
+const_iterator skip_index_lower_bound(SkipIndex *index, int value);
+
+// Returns an iterator to the first element that is greater than "value", or cend if there is none.
+// The elements in [lo, hi] are the range [skip_index_lower_bound(lo), skip_index_upper_bound(hi)).
+const_iterator skip_index_upper_bound(SkipIndex *index, int value);
+
+// Returns an iterator to the first element equal to "value", or cend if there is none.
+const_iterator skip_index_find(SkipIndex *index, int value);
+
+// Inserts "value" after the elements that are not greater than it, keeping the list sorted, and
+// returns an iterator to the new element. Expected O(log n).
+iterator skip_index_insert(SkipIndex *index, int value);
+
+// Removes all elements equal to "value" and returns the number of elements removed.
+// Expected O(log n + number of elements removed).
+size_t skip_index_erase(SkipIndex *index, int value);
+
+#endif // SKIP_INDEX_H
@@ -1,5 +1,14 @@
 #include "forward_list.h"
+#include "hash_index.h"
+#include "list_image.h"
+#include "node_pool.h"
+#include "packed_list.h"
+#include "reclaimer.h"
+#include "segment_index.h"
+#include "skip_index.h"
 #include "test-framework/unity.h"
+#include <limits.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #define SIZE 10
@@ -86,7 +95,7 @@ static void test_if_front_equal_to_first(void)
 {
     List *list = create_list();
     random_fill(list, 10);
-    TEST_ASSERT(*front(list) == list->head->value);
+    TEST_ASSERT(*cfront(list) == list->head->value);
     destroy_list(list);
 }
 
@@ -196,7 +205,7 @@ static void test_push_front_when_list_not_empty(void)
     push_front(list, val);
 
     TEST_ASSERT(distance(cbegin(list), cend(list)) == size + 1);
-    TEST_ASSERT(*front(list) == val);
+    TEST_ASSERT(*cfront(list) == val);
 
     destroy_list(list);
 }
@@ -429,6 +438,1407 @@ static void test_find_found(void)
     destroy_list(list);
 }
 
+static void test_list_image_save_and_open(void)
+{
+    const char *path = "test_list.img";
+    List *list = create_list();
+
+    random_fill(list, 1000);
+
+    TEST_ASSERT(list_image_save(list, path) == 0);
+
+    // The second mapping cannot use the preferred base, so it exercises relocation.
+    ListImage *image1 = list_image_open(path);
+    ListImage *image2 = list_image_open(path);
+
+    TEST_ASSERT_NOT_NULL(image1);
+    TEST_ASSERT_NOT_NULL(image2);
+    TEST_ASSERT(list_image_size(image1) == 1000);
+    TEST_ASSERT(distance(list_image_cbegin(image2), list_image_cend(image2)) == 1000);
+
+    const_iterator iter1 = list_image_cbegin(image1);
+    const_iterator iter2 = list_image_cbegin(image2);
+    for (Node *p = list->head; p != NULL; p = p->pNext)
+    {
+        TEST_ASSERT(iter1.current->value == p->value);
+        TEST_ASSERT(iter2.current->value == p->value);
+        const_next(&iter1);
+        const_next(&iter2);
+    }
+
+    list_image_close(image1);
+    list_image_close(image2);
+    remove(path);
+    destroy_list(list);
+}
+
+static void test_packed_list_round_trip(void)
+{
+    List *list = create_list();
+
+    for (int i = 1000; i > 0; --i)
+        push_front(list, i * 3);
+    push_front(list, -2147483647 - 1);
+
+    PackedList *packed = packed_from_list(list);
+
+    TEST_ASSERT_TRUE(packed_is_sorted(packed));
+    TEST_ASSERT(packed_size(packed) == 1001);
+    TEST_ASSERT(packed_memory_usage(packed) < 1001 * sizeof(Node) / 5);
+
+    List *unpacked = packed_to_list(packed);
+    const_iterator iter = cbegin(unpacked);
+    for (Node *p = list->head; p != NULL; p = p->pNext)
+    {
+        TEST_ASSERT(iter.current->value == p->value);
+        const_next(&iter);
+    }
+    TEST_ASSERT_NULL(iter.current);
+
+    packed_destroy(packed);
+    destroy_list(unpacked);
+    destroy_list(list);
+}
+
+static void test_packed_list_unsorted(void)
+{
+    List *list = create_list();
+
+    random_fill(list, 500);
+    push_front(list, 2147483647);
+    push_front(list, -2147483647 - 1);
+
+    PackedList *packed = packed_from_list(list);
+    List *unpacked = packed_to_list(packed);
+
+    TEST_ASSERT(packed_is_sorted(packed) == is_sorted(cbegin(list), cend(list)));
+    TEST_ASSERT(distance(cbegin(unpacked), cend(unpacked)) == 502);
+
+    packed_iterator iter = packed_cbegin(packed);
+    for (Node *p = unpacked->head; p != NULL; p = p->pNext)
+    {
+        TEST_ASSERT(iter.value == p->value);
+        packed_next(&iter);
+    }
+
+    packed_destroy(packed);
+    destroy_list(unpacked);
+    destroy_list(list);
+}
+
+static void test_packed_list_cfind(void)
+{
+    List *list = create_list();
+
+    for (int i = 1000; i > 0; --i)
+        push_front(list, i * 2);
+
+    PackedList *packed = packed_from_list(list);
+
+    TEST_ASSERT(packed_cfind(packed, 2).position == 0);
+    TEST_ASSERT(packed_cfind(packed, 512).position == 255);
+    TEST_ASSERT(packed_cfind(packed, 2000).value == 2000);
+    TEST_ASSERT(packed_cfind(packed, 513).position == packed_size(packed));
+    TEST_ASSERT(packed_cfind(packed, 5000).position == packed_size(packed));
+
+    packed_destroy(packed);
+    destroy_list(list);
+}
+
+static void test_packed_list_merge(void)
+{
+    List *list1 = create_list();
+    List *list2 = create_list();
+
+    random_fill(list1, 300);
+    sort(list1);
+    random_fill(list2, 200);
+    sort(list2);
+
+    PackedList *packed1 = packed_from_list(list1);
+    PackedList *packed2 = packed_from_list(list2);
+    PackedList *merged = packed_merge(packed1, packed2);
+
+    merge(list1, list2);
+
+    TEST_ASSERT(packed_size(merged) == distance(cbegin(list1), cend(list1)));
+    TEST_ASSERT_TRUE(packed_is_sorted(merged));
+
+    packed_iterator iter = packed_cbegin(merged);
+    for (Node *p = list1->head; p != NULL; p = p->pNext)
+    {
+        TEST_ASSERT(iter.value == p->value);
+        packed_next(&iter);
+    }
+
+    packed_destroy(packed1);
+    packed_destroy(packed2);
+    packed_destroy(merged);
+    destroy_list(list1);
+    destroy_list(list2);
+}
+
+static void test_list_write_and_read_text(void)
+{
+    List *list = create_list();
+
+    random_fill(list, 20000);
+    push_front(list, 2147483647);
+    push_front(list, -2147483647 - 1);
+
+    FILE *stream = tmpfile();
+    TEST_ASSERT_NOT_NULL(stream);
+    TEST_ASSERT(list_write_text(list, stream) == 0);
+    rewind(stream);
+
+    List *read = list_read_text(stream);
+    TEST_ASSERT_NOT_NULL(read);
+
+    const_iterator iter = cbegin(read);
+    for (Node *p = list->head; p != NULL; p = p->pNext)
+    {
+        TEST_ASSERT(iter.current->value == p->value);
+        const_next(&iter);
+    }
+    TEST_ASSERT_NULL(iter.current);
+
+    fclose(stream);
+    destroy_list(read);
+    destroy_list(list);
+}
+
+static void test_list_write_text_fills_buffer(void)
+{
+    // 4369 elements of 15 characters leave 16 bytes of the buffer before the last one.
+    List *list = create_list();
+    assign(list, 4369, INT_MIN);
+
+    FILE *stream = tmpfile();
+    TEST_ASSERT_NOT_NULL(stream);
+    TEST_ASSERT(list_write_text(list, stream) == 0);
+    rewind(stream);
+
+    List *read = list_read_text(stream);
+    TEST_ASSERT_NOT_NULL(read);
+    TEST_ASSERT(distance(cbegin(read), cend(read)) == 4369);
+    TEST_ASSERT(before_end(read).current->value == INT_MIN);
+
+    fclose(stream);
+    destroy_list(read);
+    destroy_list(list);
+}
+
+static void test_list_read_text_malformed(void)
+{
+    const char *inputs[] = {"", "1 -> 2", "1 -> x -> NULL\n", "1 2 -> NULL", "2147483648 -> NULL",
+                            "99999999999999999999 -> NULL", "NULL 1"};
+
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i)
+    {
+        FILE *stream = tmpfile();
+        fputs(inputs[i], stream);
+        rewind(stream);
+
+        TEST_ASSERT_NULL(list_read_text(stream));
+
+        fclose(stream);
+    }
+
+    FILE *stream = tmpfile();
+    fputs("NULL\n", stream);
+    rewind(stream);
+
+    List *list = list_read_text(stream);
+    TEST_ASSERT_TRUE(empty(list));
+
+    fclose(stream);
+    destroy_list(list);
+}
+
+static void test_to_forward_list(void)
+{
+    int arr[] = {3, 1, 4, 1, 5};
+
+    List *list = to_forward_list(arr, 5);
+
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 5);
+    TEST_ASSERT(*cfront(list) == 3);
+
+    destroy_list(list);
+}
+
+static void test_view_algorithms(void)
+{
+    int arr[] = {1, 2, 2, 3, 5, 8};
+    ListView view = make_view(arr, 6);
+
+    TEST_ASSERT(view_distance(view_cbegin(&view), view_cend(&view)) == 6);
+    TEST_ASSERT_TRUE(view_is_sorted(view_cbegin(&view), view_cend(&view)));
+    TEST_ASSERT(view_find(view_cbegin(&view), view_cend(&view), 3).current == &arr[3]);
+    TEST_ASSERT(view_find(view_cbegin(&view), view_cend(&view), 4).current == view_cend(&view).current);
+    TEST_ASSERT_NULL(view.owned);
+
+    destroy_view(&view);
+}
+
+static void test_view_mutable(void)
+{
+    int arr[] = {5, 4, 3};
+    ListView view = make_view(arr, 3);
+
+    List *list = view_mutable(&view);
+    push_front(list, 6);
+
+    TEST_ASSERT(view_mutable(&view) == list);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 4);
+    TEST_ASSERT(view_distance(view_cbegin(&view), view_cend(&view)) == 3);
+    TEST_ASSERT_FALSE(view_is_sorted(view_cbegin(&view), view_cend(&view)));
+
+    destroy_view(&view);
+}
+
+static void test_assign_bulk_values(void)
+{
+    List *list = create_list();
+
+    assign(list, 100000, 7);
+
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 100000);
+    TEST_ASSERT_NULL(cfind(cbegin(list), cend(list), 0).current);
+
+    destroy_list(list);
+}
+
+static void test_node_pool_chain(void)
+{
+    Node *single = node_pool_alloc();
+    node_pool_free(single);
+
+    Node *tail;
+    Node *chain = node_pool_alloc_chain(5000, &tail);
+
+    size_t count = 1;
+    Node *p = chain;
+    while (p->pNext)
+    {
+        p = p->pNext;
+        ++count;
+    }
+
+    TEST_ASSERT(count == 5000);
+    TEST_ASSERT(p == tail);
+
+    node_pool_free_chain(chain, tail);
+}
+
+static void test_before_begin(void)
+{
+    List *list = create_list();
+
+    iterator iter = insert_after(before_begin(list), 2);
+    insert_after(before_begin(list), 1);
+    insert_after(iter, 3);
+
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 3);
+    TEST_ASSERT(*cfront(list) == 1);
+    TEST_ASSERT(distance(cbefore_begin(list), cend(list)) == 4);
+
+    erase_after(before_begin(list));
+    TEST_ASSERT(*cfront(list) == 2);
+
+    List *other = create_list();
+    push_front(other, 0);
+    push_front(other, -1);
+    splice_after(before_begin(list), other);
+    TEST_ASSERT(*cfront(list) == -1);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 4);
+    TEST_ASSERT_TRUE(is_sorted(cbegin(list), cend(list)));
+
+    destroy_list(other);
+    destroy_list(list);
+}
+
+static void test_remove_at_head(void)
+{
+    List *list = create_list();
+
+    assign(list, 5, 420);
+    push_front(list, 69);
+    push_front(list, 420);
+
+    TEST_ASSERT(remove_(list, 420) == 6);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 1);
+    TEST_ASSERT(*cfront(list) == 69);
+
+    destroy_list(list);
+}
+
+static void test_unique(void)
+{
+    List *list = create_list();
+
+    unique(list);
+
+    int arr[] = {1, 1, 1, 2, 3, 3, 1, 4, 4};
+    List *filled = to_forward_list(arr, 9);
+    unique(filled);
+
+    TEST_ASSERT(distance(cbegin(filled), cend(filled)) == 5);
+
+    destroy_list(filled);
+    destroy_list(list);
+}
+
+static void test_erase_after_range(void)
+{
+    int arr[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    List *list = to_forward_list(arr, 10);
+
+    iterator first = begin(list);
+    iterator last = begin(list);
+    advance(&first, 2);
+    advance(&last, 6);
+
+    iterator result = erase_after_range(first, last);
+
+    TEST_ASSERT(result.current == last.current);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 7);
+    TEST_ASSERT(first.current->pNext->value == 6);
+
+    // Trims the tail and then the front.
+    erase_after_range(last, end(list));
+    erase_after_range(before_begin(list), first);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 2);
+    TEST_ASSERT(*cfront(list) == 2);
+
+    // The released nodes are reused.
+    assign(list, 1000, 1);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 1000);
+
+    destroy_list(list);
+}
+
+static Node *last_node(List *list)
+{
+    Node *last = &list->before_head;
+    while (last->pNext)
+        last = last->pNext;
+
+    return last;
+}
+
+static void test_tail_tracking(void)
+{
+    List *list = create_list();
+
+    TEST_ASSERT(list->tail == last_node(list));
+    push_front(list, 1);
+    TEST_ASSERT(list->tail == last_node(list));
+    insert_after(begin(list), 2);
+    TEST_ASSERT(list->tail == last_node(list));
+    random_fill(list, 10);
+    erase_after(before_begin(list));
+    TEST_ASSERT(list->tail == last_node(list));
+    reverse(list);
+    TEST_ASSERT(list->tail == last_node(list));
+    remove_(list, 1);
+    TEST_ASSERT(list->tail == last_node(list));
+    sort(list);
+    TEST_ASSERT(list->tail == last_node(list));
+    unique(list);
+    TEST_ASSERT(list->tail == last_node(list));
+    resize(list, 20);
+    TEST_ASSERT(list->tail == last_node(list));
+    resize(list, 3);
+    TEST_ASSERT(list->tail == last_node(list));
+    erase_after_range(begin(list), end(list));
+    TEST_ASSERT(list->tail == last_node(list));
+    pop_front(list);
+    TEST_ASSERT(list->tail == &list->before_head);
+
+    // Iterators from find and next carry their list, so erasing the tail through them moves it back.
+    int arr[] = {1, 2, 3};
+    assign_array(list, arr, 3);
+    List *other = create_list();
+    push_front(other, 4);
+    iterator two = find(begin(list), end(list), 2);
+    TEST_ASSERT(two.owner == list);
+    erase_after(two);
+    TEST_ASSERT(list->tail == two.current);
+    splice_after(before_end(list), other);
+    int expected[] = {1, 2, 4};
+    int *values = to_array(list);
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, values, 3);
+    free(values);
+    TEST_ASSERT(list->tail == last_node(list));
+
+    destroy_list(other);
+    destroy_list(list);
+}
+
+static void test_splice_after_one(void)
+{
+    int arr1[] = {1, 2, 3};
+    int arr2[] = {10, 20, 30};
+    List *list1 = to_forward_list(arr1, 3);
+    List *list2 = to_forward_list(arr2, 3);
+
+    iterator last = begin(list1);
+    advance(&last, 2);
+
+    iterator it = begin(list2);
+    next(&it);
+
+    // Moves 30, the tail of list2, to the end of list1.
+    splice_after_one(last, list2, it);
+
+    TEST_ASSERT(distance(cbegin(list1), cend(list1)) == 4);
+    TEST_ASSERT(list1->tail->value == 30);
+    TEST_ASSERT(list2->tail->value == 20);
+    TEST_ASSERT(list1->tail == last_node(list1));
+    TEST_ASSERT(list2->tail == last_node(list2));
+
+    // Moves 10 to the front of list1.
+    splice_after_one(before_begin(list1), list2, before_begin(list2));
+    TEST_ASSERT(*cfront(list1) == 10);
+    TEST_ASSERT(*cfront(list2) == 20);
+
+    destroy_list(list1);
+    destroy_list(list2);
+}
+
+static void test_splice_after_range(void)
+{
+    int arr1[] = {1, 2};
+    int arr2[] = {10, 20, 30, 40, 50};
+    List *list1 = to_forward_list(arr1, 2);
+    List *list2 = to_forward_list(arr2, 5);
+
+    iterator first = begin(list2);
+    iterator last = begin(list2);
+    advance(&last, 3);
+
+    // Moves 20 and 30 to the front of list1.
+    splice_after_range(before_begin(list1), list2, first, last);
+    TEST_ASSERT(*cfront(list1) == 20);
+    TEST_ASSERT(distance(cbegin(list1), cend(list1)) == 4);
+    TEST_ASSERT(distance(cbegin(list2), cend(list2)) == 3);
+
+    // Moves the rest of list2 after the tail of list1, using the tracked tail.
+    splice_after_range(before_end(list1), list2, begin(list2), end(list2));
+    TEST_ASSERT(list1->tail->value == 50);
+    TEST_ASSERT(list1->tail == last_node(list1));
+    TEST_ASSERT(list2->tail == last_node(list2));
+    TEST_ASSERT(distance(cbegin(list2), cend(list2)) == 1);
+
+    splice_after(begin(list1), list2);
+    TEST_ASSERT(empty(list2));
+    TEST_ASSERT(list2->tail == &list2->before_head);
+    TEST_ASSERT(distance(cbegin(list1), cend(list1)) == 7);
+
+    destroy_list(list1);
+    destroy_list(list2);
+}
+
+static void test_reclaimer(void)
+{
+    ReclaimerStats before = reclaimer_stats();
+
+    reclaimer_start(1000, 0);
+    TEST_ASSERT_TRUE(reclaimer_running());
+
+    List *list = create_list();
+    assign(list, 10000, 1);
+    clear(list);
+    TEST_ASSERT_TRUE(empty(list));
+
+    random_fill(list, 500);
+    iterator first = begin(list);
+    advance(&first, 99);
+    erase_after_range(first, end(list));
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 100);
+
+    destroy_list(list);
+    reclaimer_stop();
+    TEST_ASSERT_FALSE(reclaimer_running());
+
+    ReclaimerStats after = reclaimer_stats();
+    TEST_ASSERT(after.pending_ranges == 0);
+    TEST_ASSERT(after.submitted_ranges - before.submitted_ranges == 3);
+    TEST_ASSERT(after.reclaimed_nodes - before.reclaimed_nodes == 10500);
+    TEST_ASSERT(after.batches - before.batches >= 11);
+}
+
+static void test_node_pool_thread_stats(void)
+{
+    List *list = create_list();
+    NodePoolStats before = node_pool_thread_stats();
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        push_front(list, i);
+        pop_front(list);
+    }
+
+    NodePoolStats after = node_pool_thread_stats();
+
+    TEST_ASSERT(after.hits + after.misses - before.hits - before.misses == 1000);
+    TEST_ASSERT(after.misses - before.misses <= 1);
+
+    destroy_list(list);
+}
+
+typedef struct CountingAllocator
+{
+    size_t allocations;
+    size_t releases;
+} CountingAllocator;
+
+static void *counting_alloc(size_t size, void *ctx)
+{
+    ++((CountingAllocator *)ctx)->allocations;
+    return malloc(size);
+}
+
+static void counting_free(void *ptr, void *ctx)
+{
+    ++((CountingAllocator *)ctx)->releases;
+    free(ptr);
+}
+
+static void test_create_list_with_allocator(void)
+{
+    CountingAllocator counter = {0, 0};
+    List *list = create_list_with_allocator(counting_alloc, counting_free, &counter);
+
+    assign(list, 10, 5);
+    push_front(list, 1);
+    insert_after(begin(list), 2);
+    erase_after(begin(list));
+    resize(list, 20);
+    resize(list, 10);
+    sort(list);
+    remove_(list, 5);
+
+    TEST_ASSERT(counter.allocations == 1 + 10 + 1 + 1 + 9);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 1);
+
+    // Nodes coming from the node pool are copied into the list's allocator.
+    List *pooled = create_list();
+    assign(pooled, 3, 7);
+    merge(list, pooled);
+    assign(pooled, 2, 9);
+    splice_after(before_end(list), pooled);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 6);
+    TEST_ASSERT_TRUE(empty(pooled));
+
+    // swap() hands the allocator over together with the nodes.
+    swap(list, pooled);
+    TEST_ASSERT(pooled->alloc_ctx == &counter);
+    TEST_ASSERT_NULL(list->alloc_ctx);
+
+    destroy_list(list);
+    destroy_list(pooled);
+
+    TEST_ASSERT(counter.allocations == counter.releases);
+}
+
+// Hands out memory from a static block, which must never reach free().
+typedef struct ArenaAllocator
+{
+    _Alignas(max_align_t) char memory[4096];
+    size_t used;
+    size_t releases;
+} ArenaAllocator;
+
+static void *arena_alloc(size_t size, void *ctx)
+{
+    ArenaAllocator *arena = (ArenaAllocator *)ctx;
+    size = (size + _Alignof(max_align_t) - 1) / _Alignof(max_align_t) * _Alignof(max_align_t);
+    if (arena->used + size > sizeof(arena->memory))
+        return NULL;
+
+    void *p = arena->memory + arena->used;
+    arena->used += size;
+    return p;
+}
+
+static void arena_free(void *ptr, void *ctx)
+{
+    ArenaAllocator *arena = (ArenaAllocator *)ctx;
+    TEST_ASSERT((char *)ptr >= arena->memory && (char *)ptr < arena->memory + sizeof(arena->memory));
+    ++arena->releases;
+}
+
+static void test_swap_keeps_list_allocator(void)
+{
+    static ArenaAllocator arena;
+    List *own = create_list_with_allocator(arena_alloc, arena_free, &arena);
+    List *pooled = create_list();
+
+    assign(own, 5, 1);
+    assign(pooled, 3, 2);
+    swap(own, pooled);
+
+    // Each structure is still released by the allocator that created it, the nodes by theirs.
+    TEST_ASSERT(own->alloc_ctx == NULL);
+    TEST_ASSERT(pooled->alloc_ctx == &arena);
+    destroy_list(own);
+    TEST_ASSERT(arena.releases == 1);
+    destroy_list(pooled);
+    TEST_ASSERT(arena.releases == 1 + 5);
+}
+
+static void test_reclaimer_skips_custom_allocators(void)
+{
+    ReclaimerStats before = reclaimer_stats();
+    CountingAllocator *counter = (CountingAllocator *)calloc(1, sizeof(CountingAllocator));
+
+    reclaimer_start(10, 0);
+    List *list = create_list_with_allocator(counting_alloc, counting_free, counter);
+    assign(list, 100, 1);
+    clear(list);
+    TEST_ASSERT(counter->releases == 100);
+
+    // The context can go as soon as the list is gone.
+    assign(list, 100, 1);
+    destroy_list(list);
+    TEST_ASSERT(counter->releases == counter->allocations);
+    free(counter);
+    reclaimer_stop();
+
+    TEST_ASSERT(reclaimer_stats().submitted_ranges == before.submitted_ranges);
+}
+
+static void test_node_pool_huge_pages(void)
+{
+    NodePoolChunkStats before = node_pool_chunk_stats();
+    List *list = create_list();
+
+    // More nodes than the pool holds, so that at least one new chunk is needed.
+    size_t count = before.bytes / sizeof(Node) + 1000;
+
+    node_pool_use_huge_pages(1);
+    assign(list, count, 3);
+    node_pool_use_huge_pages(0);
+
+    NodePoolChunkStats after = node_pool_chunk_stats();
+
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == count);
+    TEST_ASSERT(after.chunks > before.chunks);
+
+    destroy_list(list);
+}
+
+static void test_list_migrate(void)
+{
+    int arr[] = {4, 8, 15, 16, 23, 42};
+    List *list = to_forward_list(arr, 6);
+    CountingAllocator counter = {0, 0};
+    List *own = create_list_with_allocator(counting_alloc, counting_free, &counter);
+
+    TEST_ASSERT(list_migrate(list, -1) == -1);
+    TEST_ASSERT(list_migrate(list, NODE_POOL_MAX_NUMA_NODES) == -1);
+
+    // Node 0 exists on every system, but the kernel may still refuse memory policies.
+    if (list_migrate(list, 0) == 0)
+    {
+        for (Node *p = list->head; p->pNext != NULL; p = p->pNext)
+            TEST_ASSERT(p->pNext == p + 1);
+    }
+
+    int *moved = to_array(list);
+    TEST_ASSERT_EQUAL_INT_ARRAY(arr, moved, 6);
+    TEST_ASSERT(before_end(list).current->value == 42);
+    free(moved);
+
+    // Lists with their own allocator stay where their allocator put them.
+    push_front(own, 1);
+    TEST_ASSERT(list_migrate(own, 0) == -1);
+    TEST_ASSERT(*cfront(own) == 1);
+
+    destroy_list(list);
+    destroy_list(own);
+}
+
+static void test_skip_index(void)
+{
+    List *list = create_list();
+    for (int i = 999; i >= 0; --i)
+        push_front(list, 2 * i);
+
+    SkipIndex *index = skip_index_attach(list);
+    TEST_ASSERT_NOT_NULL(index);
+    TEST_ASSERT(list->skip_index == index);
+    TEST_ASSERT(skip_index_attach(list) == index);
+
+    TEST_ASSERT(skip_index_find(index, 500).current->value == 500);
+    TEST_ASSERT_NULL(skip_index_find(index, 501).current);
+    TEST_ASSERT_NULL(skip_index_find(index, 2000).current);
+    TEST_ASSERT(skip_index_lower_bound(index, 501).current->value == 502);
+    TEST_ASSERT(skip_index_upper_bound(index, 502).current->value == 504);
+    TEST_ASSERT(distance(skip_index_lower_bound(index, 100), skip_index_upper_bound(index, 200)) == 51);
+
+    // Sorted inserts and erases keep the list sorted and the index usable.
+    for (int i = 0; i < 1000; ++i)
+        skip_index_insert(index, 2 * i + 1);
+    skip_index_insert(index, 7);
+    skip_index_insert(index, -5);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 2002);
+    TEST_ASSERT_TRUE(is_sorted(cbegin(list), cend(list)));
+    TEST_ASSERT(*cfront(list) == -5);
+    TEST_ASSERT(distance(skip_index_lower_bound(index, 7), skip_index_upper_bound(index, 7)) == 2);
+
+    TEST_ASSERT(skip_index_erase(index, 7) == 2);
+    TEST_ASSERT(skip_index_erase(index, 7) == 0);
+    TEST_ASSERT(skip_index_erase(index, 1999) == 1);
+    TEST_ASSERT(before_end(list).current->value == 1998);
+    TEST_ASSERT(skip_index_find(index, 8).current->value == 8);
+
+    // Changes made without the index are picked up on its next use.
+    erase_after(before_begin(list));
+    push_front(list, -100);
+    TEST_ASSERT(skip_index_find(index, -100).current == list->head);
+    TEST_ASSERT_NULL(skip_index_find(index, -5).current);
+    TEST_ASSERT(skip_index_lower_bound(index, 1000).current->value == 1000);
+
+    // A list left unsorted is not reordered; the index finds nothing until the list is sorted again.
+    push_front(list, 1000);
+    TEST_ASSERT_NULL(skip_index_find(index, 1000).current);
+    TEST_ASSERT_NULL(skip_index_insert(index, 3).current);
+    TEST_ASSERT(skip_index_erase(index, 1000) == 0);
+    TEST_ASSERT(*cfront(list) == 1000);
+    sort(list);
+    TEST_ASSERT(skip_index_find(index, 1000).current->value == 1000);
+    TEST_ASSERT(skip_index_insert(index, 3).current->value == 3);
+
+    skip_index_detach(list);
+    TEST_ASSERT_NULL(list->skip_index);
+
+    push_front(list, 5000);
+    TEST_ASSERT_NULL(skip_index_attach(list));
+
+    // destroy_list() releases an index that is still attached.
+    List *other = create_list();
+    push_front(other, 1);
+    TEST_ASSERT_NOT_NULL(skip_index_attach(other));
+    destroy_list(other);
+
+    destroy_list(list);
+}
+
+static void test_insert_sorted_and_lower_bound(void)
+{
+    List *list = create_list();
+    int values[] = {5, 1, 9, 5, 3, 12, -4};
+    for (int i = 0; i < 7; ++i)
+        insert_sorted(list, values[i]);
+
+    int expected[] = {-4, 1, 3, 5, 5, 9, 12};
+    int *arr = to_array(list);
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, arr, 7);
+    free(arr);
+    TEST_ASSERT_TRUE(list->sorted);
+    TEST_ASSERT(before_end(list).current->value == 12);
+
+    TEST_ASSERT(lower_bound(cbegin(list), cend(list), 5).current->value == 5);
+    TEST_ASSERT(lower_bound(cbegin(list), cend(list), 6).current->value == 9);
+    TEST_ASSERT_NULL(lower_bound(cbegin(list), cend(list), 13).current);
+
+    // An element out of order clears the flag, and insert_sorted sorts before inserting.
+    push_front(list, 100);
+    TEST_ASSERT_FALSE(list->sorted);
+    insert_sorted(list, 4);
+    TEST_ASSERT_TRUE(list->sorted);
+    TEST_ASSERT_TRUE(is_sorted(cbegin(list), cend(list)));
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 9);
+
+    // Elements that fit in place keep it.
+    push_front(list, -10);
+    insert_after(before_end(list), 100);
+    TEST_ASSERT_TRUE(list->sorted);
+
+    reverse(list);
+    TEST_ASSERT_FALSE(list->sorted);
+    sort(list);
+    TEST_ASSERT_TRUE(list->sorted);
+    TEST_ASSERT_TRUE(is_sorted(cbegin(list), cend(list)));
+
+    destroy_list(list);
+}
+
+static void test_hash_index(void)
+{
+    int arr[] = {3, 7, 7, 1, 7, 3, 9, 7, 0, 0};
+    List *list = to_forward_list(arr, 10);
+
+    TEST_ASSERT(count(list, 7) == 4);
+    TEST_ASSERT_FALSE(contains(list, 5));
+
+    HashIndex *index = hash_index_attach(list);
+    TEST_ASSERT(hash_index_attach(list) == index);
+    TEST_ASSERT(count(list, 7) == 4);
+    TEST_ASSERT(count(list, 0) == 2);
+    TEST_ASSERT_TRUE(contains(list, 9));
+    TEST_ASSERT_FALSE(contains(list, 5));
+    TEST_ASSERT(hash_index_find(index, 1).current == list->head->pNext->pNext->pNext);
+
+    // Runs of matches, including one at the end, are unlinked together.
+    TEST_ASSERT(remove_(list, 7) == 4);
+    TEST_ASSERT(remove_(list, 0) == 2);
+    TEST_ASSERT(remove_(list, 7) == 0);
+    int expected[] = {3, 1, 3, 9};
+    int *values = to_array(list);
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, values, 4);
+    free(values);
+    TEST_ASSERT(before_end(list).current->value == 9);
+
+    TEST_ASSERT(remove_(list, 3) == 2);
+    TEST_ASSERT(*cfront(list) == 1);
+    TEST_ASSERT(count(list, 3) == 0);
+
+    // Changes made without the index are picked up on its next use.
+    push_front(list, 9);
+    insert_after(before_end(list), 4);
+    TEST_ASSERT(count(list, 9) == 2);
+    TEST_ASSERT(remove_(list, 9) == 2);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 2);
+    TEST_ASSERT(hash_index_find(index, 4).current == before_end(list).current);
+
+    destroy_list(list);
+}
+
+static void test_hash_index_follows_inserts_and_erases(void)
+{
+    int arr[] = {5, 1, 5, 2};
+    List *list = to_forward_list(arr, 4);
+    HashIndex *index = hash_index_attach(list);
+
+    // Each of these keeps the tables up to date instead of leaving them to be rebuilt.
+    push_front(list, 5);
+    TEST_ASSERT(index->version == list->version);
+    TEST_ASSERT(hash_index_find(index, 5).current == list->head);
+
+    iterator second = begin(list);
+    next(&second);
+    iterator middle = insert_after(second, 5);
+    insert_after(before_end(list), 5);
+    TEST_ASSERT(index->version == list->version);
+    TEST_ASSERT(count(list, 5) == 5);
+
+    erase_after(before_begin(list));
+    TEST_ASSERT(index->version == list->version);
+    TEST_ASSERT(hash_index_find(index, 5).current == list->head);
+    TEST_ASSERT(list->head->pNext == middle.current);
+    TEST_ASSERT(count(list, 5) == 4);
+
+    // Nodes released by pop_front() are handed out again by push_front().
+    for (int i = 0; i < 1000; ++i)
+    {
+        push_front(list, i % 3);
+        pop_front(list);
+    }
+    TEST_ASSERT(index->version == list->version);
+
+    TEST_ASSERT(remove_(list, 5) == 4);
+    int expected[] = {1, 2};
+    int *values = to_array(list);
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, values, 2);
+    free(values);
+    TEST_ASSERT(before_end(list).current->value == 2);
+
+    // Every new value takes a slot, even when its node reuses an entry, so distinct values force rebuilds.
+    List *empty_list = create_list();
+    hash_index_attach(empty_list);
+    for (int i = 0; i < 1000; ++i)
+    {
+        push_front(empty_list, i);
+        TEST_ASSERT_TRUE(contains(empty_list, i));
+        pop_front(empty_list);
+    }
+    TEST_ASSERT_FALSE(contains(empty_list, 999));
+    destroy_list(empty_list);
+
+    // The same as a queue over a longer list.
+    List *queue = create_list();
+    for (int i = 0; i < 1000; ++i)
+        push_front(queue, i);
+    hash_index_attach(queue);
+    for (int i = 1000; i < 6000; ++i)
+    {
+        insert_after(before_end(queue), i);
+        erase_after(before_begin(queue));
+        TEST_ASSERT(count(queue, i) == 1);
+    }
+    TEST_ASSERT(distance(cbegin(queue), cend(queue)) == 1000);
+    destroy_list(queue);
+
+    // Inserting many elements outgrows the tables, which are then rebuilt once.
+    for (int i = 0; i < 1000; ++i)
+        push_front(list, i);
+    TEST_ASSERT(count(list, 999) == 1);
+    TEST_ASSERT(count(list, 2) == 2);
+    TEST_ASSERT(remove_(list, 2) == 2);
+    TEST_ASSERT(before_end(list).current->value == 1);
+
+    destroy_list(list);
+}
+
+static void test_sort_after_writes(void)
+{
+    List *list = create_list();
+    assign(list, 3, 0);
+    HashIndex *index = hash_index_attach(list);
+    TEST_ASSERT(count(list, 0) == 3);
+
+    // Reading leaves the list and its index alone.
+    unsigned long version = list->version;
+    TEST_ASSERT(*cfront(list) == 0);
+    TEST_ASSERT(list->version == version);
+    TEST_ASSERT_TRUE(list->sorted);
+
+    *front(list) = 5;
+    TEST_ASSERT_FALSE(list->sorted);
+    TEST_ASSERT(count(list, 0) == 2);
+    TEST_ASSERT(hash_index_count(index, 5) == 1);
+    sort(list);
+    TEST_ASSERT(*cfront(list) == 0);
+    TEST_ASSERT(before_end(list).current->value == 5);
+
+    sort(list);
+    iterator iter = begin(list);
+    iter.current->value = 9;
+    invalidate(list);
+    sort(list);
+    TEST_ASSERT(before_end(list).current->value == 9);
+    TEST_ASSERT(count(list, 0) == 1 && contains(list, 9));
+
+    destroy_list(list);
+}
+
+static void test_unique_all(void)
+{
+    int arr[] = {4, 1, 4, 4, 2, 1, 3, 2, 4, 5};
+    List *list = to_forward_list(arr, 10);
+
+    TEST_ASSERT(unique_all(list) == 5);
+    int expected[] = {4, 1, 2, 3, 5};
+    int *values = to_array(list);
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, values, 5);
+    free(values);
+    TEST_ASSERT(before_end(list).current->value == 5);
+    TEST_ASSERT(unique_all(list) == 0);
+
+    // The scratch set is reused, and grows for a larger list.
+    random_fill(list, 5000);
+    unique_all(list);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) <= 100);
+    for (const Node *p = list->head; p != NULL; p = p->pNext)
+        TEST_ASSERT(count(list, p->value) == 1);
+
+    // Sorted lists only need to compare neighbours.
+    sort(list);
+    push_front(list, -1);
+    push_front(list, -1);
+    TEST_ASSERT(unique_all(list) == 1);
+    TEST_ASSERT_TRUE(is_sorted(cbegin(list), cend(list)));
+
+    // Duplicates removed from a sorted list are released as one batch too.
+    int sorted_arr[] = {1, 1, 2, 3, 3, 3, 7, 7};
+    assign_array(list, sorted_arr, 8);
+    reclaimer_start(100, 0);
+    ReclaimerStats before = reclaimer_stats();
+    TEST_ASSERT(unique_all(list) == 4);
+    TEST_ASSERT(reclaimer_stats().submitted_ranges - before.submitted_ranges == 1);
+    reclaimer_stop();
+    TEST_ASSERT(before_end(list).current->value == 7);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 4);
+
+    clear(list);
+    TEST_ASSERT(unique_all(list) == 0);
+
+    destroy_list(list);
+}
+
+static void test_merge_many(void)
+{
+    List *dst = create_list();
+    List *srcs[200];
+    int a[] = {1, 4, 4, 9};
+    int b[] = {0, 4, 10};
+    int c[] = {4, 5};
+
+    assign_array(dst, a, 4);
+    srcs[0] = to_forward_list(b, 3);
+    srcs[1] = create_list();
+    srcs[2] = to_forward_list(c, 2);
+    Node *first_four = dst->head->pNext;
+    Node *second_list_four = srcs[0]->head->pNext;
+
+    merge_many(dst, srcs, 3);
+
+    int expected[] = {0, 1, 4, 4, 4, 4, 5, 9, 10};
+    int *values = to_array(dst);
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, values, 9);
+    free(values);
+    TEST_ASSERT(dst->head->pNext->pNext == first_four);
+    TEST_ASSERT(first_four->pNext->pNext == second_list_four);
+    TEST_ASSERT(before_end(dst).current->value == 10);
+    for (int i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT_TRUE(empty(srcs[i]));
+        destroy_list(srcs[i]);
+    }
+
+    // More sources than the heap on the stack holds.
+    clear(dst);
+    for (int i = 0; i < 200; ++i)
+    {
+        srcs[i] = create_list();
+        for (int j = 4; j >= 0; --j)
+            push_front(srcs[i], j * 200 + i);
+    }
+    merge_many(dst, srcs, 200);
+    TEST_ASSERT(distance(cbegin(dst), cend(dst)) == 1000);
+    TEST_ASSERT_TRUE(is_sorted(cbegin(dst), cend(dst)));
+    TEST_ASSERT(before_end(dst).current->value == 999);
+    for (int i = 0; i < 200; ++i)
+    {
+        TEST_ASSERT_TRUE(empty(srcs[i]));
+        destroy_list(srcs[i]);
+    }
+
+    destroy_list(dst);
+}
+
+static void test_merge_runs(void)
+{
+    int a[] = {1, 2, 3, 7, 8, 8, 20};
+    int b[] = {4, 5, 6, 8, 9, 30, 31};
+    List *list1 = to_forward_list(a, 7);
+    List *list2 = to_forward_list(b, 7);
+    Node *eight = list2->head->pNext->pNext->pNext;
+
+    merge(list1, list2);
+    int expected[] = {1, 2, 3, 4, 5, 6, 7, 8, 8, 8, 9, 20, 30, 31};
+    int *values = to_array(list1);
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, values, 14);
+    free(values);
+    TEST_ASSERT(eight->pNext->value == 9); // equal elements of "this" come first
+    TEST_ASSERT(before_end(list1).current->value == 31);
+    TEST_ASSERT_TRUE(empty(list2));
+
+    // Disjoint lists are concatenated.
+    int after[] = {40, 50};
+    int before[] = {-3, -2};
+    assign_array(list2, after, 2);
+    merge(list1, list2);
+    assign_array(list2, before, 2);
+    Node *last_before = list2->tail;
+    merge(list1, list2);
+    TEST_ASSERT(*cfront(list1) == -3);
+    TEST_ASSERT(last_before->pNext->value == 1);
+    TEST_ASSERT(before_end(list1).current->value == 50);
+    TEST_ASSERT(distance(cbegin(list1), cend(list1)) == 18);
+    TEST_ASSERT_TRUE(is_sorted(cbegin(list1), cend(list1)));
+
+    destroy_list(list1);
+    destroy_list(list2);
+}
+
+static size_t position_of(Node **nodes, size_t size, const Node *node)
+{
+    size_t i = 0;
+    while (i < size && nodes[i] != node)
+        ++i;
+
+    return i;
+}
+
+static void test_sort_is_stable_and_adaptive(void)
+{
+    enum { STABLE_SIZE = 3000 };
+    static Node *nodes[STABLE_SIZE];
+    List *list = create_list();
+
+    random_fill(list, STABLE_SIZE);
+    size_t i = 0;
+    for (Node *p = list->head; p != NULL; p = p->pNext)
+        nodes[i++] = p;
+
+    sort(list);
+    TEST_ASSERT_TRUE(is_sorted(cbegin(list), cend(list)));
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == STABLE_SIZE);
+    TEST_ASSERT_NULL(before_end(list).current->pNext);
+    for (const Node *p = list->head; p->pNext != NULL; p = p->pNext)
+    {
+        if (p->value == p->pNext->value)
+            TEST_ASSERT(position_of(nodes, STABLE_SIZE, p) < position_of(nodes, STABLE_SIZE, p->pNext));
+    }
+
+    // A sorted body with new elements pushed in front, and a descending list, which is reversed as one run.
+    for (int v = 0; v < 20; ++v)
+        push_front(list, 100 + v);
+    sort(list);
+    TEST_ASSERT_TRUE(is_sorted(cbegin(list), cend(list)));
+    TEST_ASSERT(before_end(list).current->value == 119);
+
+    clear(list);
+    for (int v = 0; v < 1000; ++v)
+        push_front(list, v);
+    Node *last = list->head;
+    sort(list);
+    TEST_ASSERT(before_end(list).current == last);
+    TEST_ASSERT(*cfront(list) == 0);
+    TEST_ASSERT_TRUE(is_sorted(cbegin(list), cend(list)));
+
+    destroy_list(list);
+}
+
+static int descending(int a, int b)
+{
+    return (a < b) - (a > b);
+}
+
+static size_t key_calls;
+
+static long long last_digit(int value)
+{
+    ++key_calls;
+    return value % 10;
+}
+
+static void test_sort_by(void)
+{
+    int arr[] = {INT_MAX, -1, INT_MIN, 0, 1, INT_MIN + 1, INT_MAX - 1};
+    List *list = to_forward_list(arr, 7);
+
+    sort(list);
+    int ascending[] = {INT_MIN, INT_MIN + 1, -1, 0, 1, INT_MAX - 1, INT_MAX};
+    int *values = to_array(list);
+    TEST_ASSERT_EQUAL_INT_ARRAY(ascending, values, 7);
+    free(values);
+
+    sort_by(list, descending);
+    int expected[] = {INT_MAX, INT_MAX - 1, 1, 0, -1, INT_MIN + 1, INT_MIN};
+    values = to_array(list);
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, values, 7);
+    free(values);
+    TEST_ASSERT_FALSE(list->sorted);
+    TEST_ASSERT(before_end(list).current->value == INT_MIN);
+
+    int numbers[] = {31, 12, 41, 3, 22, 50, 13, 1};
+    assign_array(list, numbers, 8);
+    key_calls = 0;
+    sort_by_key(list, last_digit);
+    TEST_ASSERT(key_calls == 8);
+    int by_digit[] = {50, 31, 41, 1, 12, 22, 3, 13};
+    values = to_array(list);
+    TEST_ASSERT_EQUAL_INT_ARRAY(by_digit, values, 8);
+    free(values);
+    TEST_ASSERT(before_end(list).current->value == 13);
+
+    destroy_list(list);
+}
+
+static void test_partial_sort_and_nth_element(void)
+{
+    List *list = create_list();
+    random_fill(list, 1000);
+    int *original = to_array(list);
+    int *sorted = to_array(list);
+    List *reference = to_forward_list(sorted, 1000);
+    sort(reference);
+    free(sorted);
+    sorted = to_array(reference);
+
+    partial_sort(list, 10);
+    int *values = to_array(list);
+    TEST_ASSERT_EQUAL_INT_ARRAY(sorted, values, 10);
+    free(values);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 1000);
+    TEST_ASSERT_NULL(before_end(list).current->pNext);
+
+    size_t positions[] = {0, 1, 499, 998, 999};
+    for (int i = 0; i < 5; ++i)
+    {
+        assign_array(list, original, 1000);
+        size_t n = positions[i];
+        iterator nth = nth_element(list, n);
+        TEST_ASSERT(nth.current->value == sorted[n]);
+
+        size_t position = 0;
+        for (const Node *p = list->head; p != NULL; p = p->pNext, ++position)
+        {
+            if (position < n)
+                TEST_ASSERT(p->value <= nth.current->value);
+            else if (position > n)
+                TEST_ASSERT(p->value >= nth.current->value);
+            else
+                TEST_ASSERT(p == nth.current);
+        }
+        TEST_ASSERT(position == 1000);
+        TEST_ASSERT_NULL(before_end(list).current->pNext);
+    }
+    TEST_ASSERT_NULL(nth_element(list, 1000).current);
+
+    // Picking pivots does not consume the sequence seeded with srand().
+    List *first = create_list();
+    List *second = create_list();
+    srand(7);
+    random_fill(first, 100);
+    srand(7);
+    invalidate(list);
+    nth_element(list, 500);
+    random_fill(second, 100);
+    int *first_values = to_array(first);
+    int *second_values = to_array(second);
+    TEST_ASSERT_EQUAL_INT_ARRAY(first_values, second_values, 100);
+    free(first_values);
+    free(second_values);
+    destroy_list(first);
+    destroy_list(second);
+
+    // Asking for everything sorts the whole list.
+    partial_sort(list, 5000);
+    TEST_ASSERT_TRUE(is_sorted(cbegin(list), cend(list)));
+
+    free(original);
+    free(sorted);
+    destroy_list(reference);
+    destroy_list(list);
+}
+
+static void odd_mask(const int *values, size_t n, uint8_t *mask)
+{
+    for (size_t i = 0; i < n; ++i)
+        mask[i] = (uint8_t)(values[i] & 1);
+}
+
+static void large_mask(const int *values, size_t n, uint8_t *mask)
+{
+    for (size_t i = 0; i < n; ++i)
+        mask[i] = values[i] >= 300;
+}
+
+static void test_remove_if_batch(void)
+{
+    List *list = create_list();
+    for (int i = 999; i >= 0; --i)
+        push_front(list, i);
+
+    TEST_ASSERT(remove_if_batch(list, odd_mask) == 500);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 500);
+    int expected = 0;
+    for (const Node *p = list->head; p != NULL; p = p->pNext, expected += 2)
+        TEST_ASSERT(p->value == expected);
+    TEST_ASSERT(before_end(list).current->value == 998);
+
+    // A removed run spanning batches, up to the end of the list.
+    TEST_ASSERT(remove_if_batch(list, large_mask) == 350);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 150);
+    TEST_ASSERT(before_end(list).current->value == 298);
+    TEST_ASSERT(remove_if_batch(list, large_mask) == 0);
+
+    TEST_ASSERT(remove_if_batch(list, odd_mask) == 0);
+    push_front(list, 1);
+    TEST_ASSERT(remove_if_batch(list, odd_mask) == 1);
+    TEST_ASSERT(*cfront(list) == 0);
+
+    destroy_list(list);
+}
+
+static void test_resize_keeps_prefix(void)
+{
+    int arr[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19};
+    List *list = to_forward_list(arr, 20);
+
+    resize(list, 15);
+    int *values = to_array(list);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 15);
+    TEST_ASSERT_EQUAL_INT_ARRAY(arr, values, 15);
+    free(values);
+    TEST_ASSERT(before_end(list).current->value == 14);
+
+    resize_value(list, 18, 7);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 18);
+    TEST_ASSERT(before_end(list).current->value == 7);
+    TEST_ASSERT_FALSE(list->sorted);
+
+    resize(list, 0);
+    TEST_ASSERT_TRUE(empty(list));
+    TEST_ASSERT_TRUE(list->sorted);
+    resize_value(list, 3, 4);
+    TEST_ASSERT(distance(cbegin(list), cend(list)) == 3);
+    TEST_ASSERT(*cfront(list) == 4);
+    TEST_ASSERT_TRUE(list->sorted);
+
+    destroy_list(list);
+}
+
+static void test_segment_index(void)
+{
+    // Nodes allocated one at a time, so segments are unlikely to be contiguous, then a stale index.
+    int arr[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    List *list = to_forward_list(arr, 10);
+    SegmentIndex *index = segment_index_attach(list, 3, 4);
+    TEST_ASSERT(index->count == 4);
+    TEST_ASSERT(segment_index_attach(list, 5, 1) == index);
+
+    reverse(list);
+    int reversed[] = {9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+    int *values = to_array(list);
+    TEST_ASSERT_EQUAL_INT_ARRAY(reversed, values, 10);
+    free(values);
+    TEST_ASSERT(before_end(list).current->value == 0);
+
+    push_front(list, 10);
+    reverse(list);
+    reverse(list);
+    int pushed[] = {10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+    values = to_array(list);
+    TEST_ASSERT_EQUAL_INT_ARRAY(pushed, values, 11);
+    free(values);
+    TEST_ASSERT(before_end(list).current->value == 0);
+    TEST_ASSERT(index->version == list->version);
+    destroy_list(list);
+
+    // Long enough for the segments to be reversed on several threads.
+    enum { LONG_SIZE = 4 * 65536 + 5 };
+    list = create_list();
+    assign(list, LONG_SIZE, 0);
+    int i = 0;
+    for (Node *p = list->head; p != NULL; p = p->pNext)
+        p->value = i++;
+    invalidate(list);
+
+    segment_index_attach(list, 65536, 4);
+    for (int round = 0; round < 3; ++round)
+    {
+        reverse(list);
+        int expected = round % 2 ? 0 : LONG_SIZE - 1;
+        int step = round % 2 ? 1 : -1;
+        int ok = 1;
+        for (Node *p = list->head; p != NULL; p = p->pNext, expected += step)
+            ok &= p->value == expected;
+        TEST_ASSERT_TRUE(ok);
+        TEST_ASSERT(expected == (round % 2 ? LONG_SIZE : -1));
+        TEST_ASSERT(before_end(list).current->value == (round % 2 ? LONG_SIZE - 1 : 0));
+    }
+
+    segment_index_detach(list);
+    TEST_ASSERT_NULL(list->segment_index);
+    reverse(list);
+    TEST_ASSERT(*cfront(list) == 0);
+    destroy_list(list);
+
+    list = create_list();
+    segment_index_attach(list, 8, 2);
+    reverse(list);
+    TEST_ASSERT_TRUE(empty(list));
+    destroy_list(list);
+}
+
 int main(void)
 {
     UnityBegin("test.c");
@@ -462,6 +1872,47 @@ int main(void)
     RUN_TEST(test_splice_after);
     RUN_TEST(test_find_not_found);
     RUN_TEST(test_find_found);
+    RUN_TEST(test_list_image_save_and_open);
+    RUN_TEST(test_packed_list_round_trip);
+    RUN_TEST(test_packed_list_unsorted);
+    RUN_TEST(test_packed_list_cfind);
+    RUN_TEST(test_packed_list_merge);
+    RUN_TEST(test_list_write_and_read_text);
+    RUN_TEST(test_list_write_text_fills_buffer);
+    RUN_TEST(test_list_read_text_malformed);
+    RUN_TEST(test_to_forward_list);
+    RUN_TEST(test_view_algorithms);
+    RUN_TEST(test_view_mutable);
+    RUN_TEST(test_assign_bulk_values);
+    RUN_TEST(test_node_pool_chain);
+    RUN_TEST(test_before_begin);
+    RUN_TEST(test_remove_at_head);
+    RUN_TEST(test_unique);
+    RUN_TEST(test_erase_after_range);
+    RUN_TEST(test_tail_tracking);
+    RUN_TEST(test_splice_after_one);
+    RUN_TEST(test_splice_after_range);
+    RUN_TEST(test_reclaimer);
+    RUN_TEST(test_node_pool_thread_stats);
+    RUN_TEST(test_create_list_with_allocator);
+    RUN_TEST(test_swap_keeps_list_allocator);
+    RUN_TEST(test_reclaimer_skips_custom_allocators);
+    RUN_TEST(test_node_pool_huge_pages);
+    RUN_TEST(test_list_migrate);
+    RUN_TEST(test_skip_index);
+    RUN_TEST(test_insert_sorted_and_lower_bound);
+    RUN_TEST(test_hash_index);
+    RUN_TEST(test_hash_index_follows_inserts_and_erases);
+    RUN_TEST(test_sort_after_writes);
+    RUN_TEST(test_unique_all);
+    RUN_TEST(test_merge_many);
+    RUN_TEST(test_merge_runs);
+    RUN_TEST(test_sort_is_stable_and_adaptive);
+    RUN_TEST(test_sort_by);
+    RUN_TEST(test_partial_sort_and_nth_element);
+    RUN_TEST(test_remove_if_batch);
+    RUN_TEST(test_resize_keeps_prefix);
+    RUN_TEST(test_segment_index);
 
     return UnityEnd();
 }